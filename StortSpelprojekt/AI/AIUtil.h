@@ -56,6 +56,14 @@ namespace AI
 	const Vec2D NEIGHBOUR_OFFSETS[8] = { { -1, 0 },{ 1, 0 },{ 0, -1 },{ 0, 1 },{ -1, -1 },{ 1, -1 },{ -1, 1 },{ 1, 1 } };	//Straight moves in 0-3, diagonal in 4-7
 	const Vec2D CLOCKWISE_ROTATION[8] = {{-1, 0},{-1, 1},{0, 1},{1, 1},{1, 0},{1, -1},{0, -1},{-1, -1}};
 
+	//Distance assuming no obstacles, with diagonal moves costing sqrt(2)
+	static float GetOctileDistance(Vec2D start, Vec2D goal)
+	{
+		int x = goal._x > start._x ? goal._x - start._x : start._x - goal._x;
+		int y = goal._y > start._y ? goal._y - start._y : start._y - goal._y;
+		return x < y ? SQRT2 * x + (y - x) : SQRT2 * y + (x - y);
+	}
+
 	static Vec2D GetNextDirection(Vec2D originalDirection, bool clockwise)
 	{
 		int counter = 8;
@@ -2,38 +2,96 @@
 
 namespace AI
 {
-	bool AStar::IsPositionValid(Vec2D pos)
+	bool AStar::IsPositionValid(Vec2D pos) const
 	{
 		return pos._x >= 0 && pos._x < _width && pos._y >= 0 && pos._y < _height;
 	}
 
+	bool AStar::IsWalkable(Vec2D pos) const
+	{
+		return IsPositionValid(pos) && GetCost(GetIndex(pos)) > 0;
+	}
+
+	int AStar::GetIndex(Vec2D pos) const
+	{
+		return pos._y * _width + pos._x;
+	}
+
+	Vec2D AStar::GetPosition(int index) const
+	{
+		return Vec2D(index % _width, index / _width);
+	}
+
+	//Returns the node at the index, resetting it first if it belongs to an earlier search
+	AStar::Node& AStar::GetNode(int index)
+	{
+		Node& node = _grid[index];
+		if (node._searchId != _searchId)
+		{
+			node._searchId = _searchId;
+			node._parent = -1;
+			node._gCost = 0.0f;
+			node._hCost = 0.0f;
+			node._open = 0;
+		}
+		return node;
+	}
+
+	/*
+		Creates the search state. The tile costs are only allocated if no shared costs are given
+	*/
+	void AStar::CreateGrid(__int16* sharedTileCosts)
+	{
+		int size = _width * _height;
+		_grid = new Node[size];
+		_openQueue.setCapacity(size);
+		_overrideIds = nullptr;
+		_overrideCosts = nullptr;
+		_ownsTileCosts = sharedTileCosts == nullptr;
+		if (_ownsTileCosts)
+		{
+			_tileCosts = new __int16[size];
+			for (int i = 0; i < size; i++)
+			{
+				_tileCosts[i] = 0;
+			}
+		}
+		else
+		{
+			_tileCosts = sharedTileCosts;
+		}
+	}
+
 	//Calculates h based on the distance to the goal
 	void AStar::CalculateHCost(Vec2D pos)
 	{
-		
-		_grid[pos._x][pos._y]._hCost = GetHeuristicDistance(pos, _goal) * _hWeight;
+		GetNode(GetIndex(pos))._hCost = GetHeuristicDistance(pos, _goal) * _hWeight;
 	}
 
 	//calculates g by adding the preceding nodes g-cost to the current tilecost.
 	void AStar::CalculateGCost(Vec2D parentPos, Vec2D currentPos)
 	{
+		int parentIndex = GetIndex(parentPos);
+		int currentIndex = GetIndex(currentPos);
+		Node& current = GetNode(currentIndex);
 		float g = 0.0f;
 		//Euclidean heuristic is locked to octile movement for now.
 		switch (_heuristicType)
 		{
 		case AStar::MANHATTAN:
 		case AStar::CHEBYSHEV:
-			g = _grid[parentPos._x][parentPos._y]._gCost + _grid[currentPos._x][currentPos._y]._tileCost;
+			g = GetNode(parentIndex)._gCost + GetCost(currentIndex);
 			break;
 		case AStar::OCTILE:
 		case AStar::EUCLIDEAN:
+		case AStar::JUMP_POINT:
 			if (parentPos._x == currentPos._x || parentPos._y == currentPos._y)
 			{
-				g = _grid[parentPos._x][parentPos._y]._gCost + _grid[currentPos._x][currentPos._y]._tileCost;
+				g = GetNode(parentIndex)._gCost + GetCost(currentIndex);
 			}
 			else
 			{
-				g = _grid[parentPos._x][parentPos._y]._gCost + SQRT2 * _grid[currentPos._x][currentPos._y]._tileCost;
+				g = GetNode(parentIndex)._gCost + SQRT2 * GetCost(currentIndex);
 			}
 			break;
 		default:
@@ -41,18 +99,19 @@ namespace AI
 		}
 
 		// tileCost <= 0 means unwalkable. open == 0 means no previous gCost, meaning g is automatically better.
-		if (_grid[currentPos._x][currentPos._y]._tileCost > 0 && (_grid[currentPos._x][currentPos._y]._open == 0 || _grid[currentPos._x][currentPos._y]._gCost > g))
+		if (GetCost(currentIndex) > 0 && (current._open == 0 || current._gCost > g))
 		{
-			_grid[currentPos._x][currentPos._y]._open = 1;
-			_grid[currentPos._x][currentPos._y]._gCost = g;
-			_grid[currentPos._x][currentPos._y]._parent = &_grid[parentPos._x][parentPos._y];
-			_openQueue.insert(_grid[currentPos._x][currentPos._y]);										//insert should logically fit outside the function, but it works better with the if-check here.
+			current._open = 1;
+			current._gCost = g;
+			current._parent = parentIndex;
+			_openQueue.insertOrDecrease(currentIndex, current._gCost + current._hCost);		//insert should logically fit outside the function, but it works better with the if-check here.
 		}
 	}
 
 	AStar::AStar()
 	{
 		_pathLength = 0;
+		_pathCapacity = 0;
 		_path = nullptr;
 		_width = 0;
 		_height = 0;
@@ -60,8 +119,14 @@ namespace AI
 		_goal = {0,0};
 		_heuristicType = MANHATTAN;
 		_hWeight = 0;
-		_openQueue = Heap<Node>();
+		_searchId = 1;
+		_overrideId = 1;
+		_nrOfExpandedNodes = 0;
 		_grid = nullptr;
+		_tileCosts = nullptr;
+		_ownsTileCosts = false;
+		_overrideIds = nullptr;
+		_overrideCosts = nullptr;
 	}
 
 	/*
@@ -70,6 +135,7 @@ namespace AI
 	AStar::AStar(int width, int height, Vec2D start, Vec2D goal, Heuristic heuristic, int hWeight)
 	{
 		_pathLength = 0;
+		_pathCapacity = 0;
 		_path = nullptr;
 		_width = width;
 		_height = height;
@@ -77,18 +143,10 @@ namespace AI
 		_goal = goal;
 		_heuristicType = heuristic;
 		_hWeight = hWeight;
-		_openQueue = Heap<Node>();
-		_grid = new Node*[_width];
-		for (__int16 i = 0; i < _width; i++)
-		{
-			_grid[i] = new Node[_height];
-			for (__int16 j = 0; j < _height; j++)
-			{
-				_grid[i][j] = Node(i, j);
-				_grid[i][j]._open = 0;
-				//CalculateHCost({i,j});
-			}
-		}
+		_searchId = 1;
+		_overrideId = 1;
+		_nrOfExpandedNodes = 0;
+		CreateGrid();
 	}
 
 
@@ -98,6 +156,7 @@ namespace AI
 	AStar::AStar(int width, int height, Heuristic heuristic, int hWeight)
 	{
 		_pathLength = 0;
+		_pathCapacity = 0;
 		_path = nullptr;
 		_width = width;
 		_height = height;
@@ -105,33 +164,58 @@ namespace AI
 		_goal = {0,0};
 		_heuristicType = heuristic;
 		_hWeight = hWeight;
-		_openQueue = Heap<Node>();
-		_grid = new Node*[_width];
-		for (__int16 i = 0; i < _width; i++)
-		{
-			_grid[i] = new Node[_height];
-			for (__int16 j = 0; j < _height; j++)
-			{
-				_grid[i][j] = Node(i, j);
-				_grid[i][j]._open = 0;
-				//CalculateHCost({i,j});
-			}
-		}
+		_searchId = 1;
+		_overrideId = 1;
+		_nrOfExpandedNodes = 0;
+		CreateGrid();
+	}
+
+	/*
+		Reads the tile costs from an array owned by someone else, so that several searches can share one map.
+		The array has to be width * height, indexed by y * width + x, and outlive the AStar.
+	*/
+	AStar::AStar(int width, int height, __int16* sharedTileCosts, Heuristic heuristic, int hWeight)
+	{
+		_pathLength = 0;
+		_pathCapacity = 0;
+		_path = nullptr;
+		_width = width;
+		_height = height;
+		_start = {0,0};
+		_goal = {0,0};
+		_heuristicType = heuristic;
+		_hWeight = hWeight;
+		_searchId = 1;
+		_overrideId = 1;
+		_nrOfExpandedNodes = 0;
+		CreateGrid(sharedTileCosts);
 	}
 
 	AStar::~AStar()
 	{
-		for (__int16 i = 0; i < _width; i++)
+		delete[] _grid;
+		if (_ownsTileCosts)
 		{
-			delete[] _grid[i];
+			delete[] _tileCosts;
 		}
-		delete[] _grid;
+		delete[] _overrideIds;
+		delete[] _overrideCosts;
 		delete[] _path;
 	}
 
+	void AStar::ShareTileCosts(__int16* sharedTileCosts)
+	{
+		if (_ownsTileCosts)
+		{
+			delete[] _tileCosts;
+			_ownsTileCosts = false;
+		}
+		_tileCosts = sharedTileCosts;
+	}
+
 	void AStar::SetTileCost(Vec2D pos, int cost)
 	{
-		_grid[pos._x][pos._y]._tileCost = cost;
+		_tileCosts[GetIndex(pos)] = cost;
 	}
 
 	void AStar::SetStartPosition(Vec2D pos)
@@ -146,7 +230,26 @@ namespace AI
 
 	int AStar::GetTileCost(Vec2D pos) const
 	{
-		return _grid[pos._x][pos._y]._tileCost;
+		return GetCost(GetIndex(pos));
+	}
+
+	/*
+		Changes the cost of a tile for the coming search only, without touching the map.
+		Has to be called after CleanMap or Init.
+	*/
+	void AStar::SetTileCostOverride(Vec2D pos, int cost)
+	{
+		if (_overrideIds == nullptr)
+		{
+			_overrideIds = new unsigned int[_width * _height];
+			_overrideCosts = new __int16[_width * _height];
+			for (int i = 0; i < _width * _height; i++)
+			{
+				_overrideIds[i] = 0;
+			}
+		}
+		_overrideIds[GetIndex(pos)] = _overrideId;
+		_overrideCosts[GetIndex(pos)] = cost;
 	}
 
 	Vec2D * AStar::GetPath() const
@@ -159,6 +262,11 @@ namespace AI
 		return _pathLength;
 	}
 
+	int AStar::GetNrOfExpandedNodes() const
+	{
+		return _nrOfExpandedNodes;
+	}
+
 	float AStar::GetHeuristicDistance(Vec2D start, Vec2D goal) const
 	{
 		float h = 0;
@@ -173,6 +281,7 @@ namespace AI
 			h = (float)(std::min(x, y) + abs(x - y));
 			break;
 		case AStar::OCTILE:
+		case AStar::JUMP_POINT:
 			h = SQRT2 * std::min(x, y) + abs(x - y);
 			break;
 		case AStar::EUCLIDEAN:
@@ -184,23 +293,37 @@ namespace AI
 		return h;
 	}
 
-	void AStar::CleanMap()
+	/*
+		Invalidates the search state of every node. Runs in constant time, the nodes are reset when they are first visited.
+	*/
+	void AStar::NewSearchId()
 	{
-		delete[] _path;
-		_path = nullptr;
-		_pathLength = 0;
-		for (__int16 i = 0; i < _width; i++)
+		_searchId++;
+		if (_searchId == 0)															//Wrapped around, every stamp is ambiguous
 		{
-			for (__int16 j = 0; j < _height; j++)
+			for (int i = 0; i < _width * _height; i++)
 			{
-				_grid[i][j]._open = 0;
-				_grid[i][j]._gCost = 0;
-				_grid[i][j]._hCost = 0;
-				_grid[i][j]._parent = nullptr;
+				_grid[i]._searchId = 0;
+				if (_overrideIds != nullptr)
+				{
+					_overrideIds[i] = _overrideIds[i] == _overrideId ? 1 : 0;		//Keeps the current overrides
+				}
 			}
+			_searchId = 1;
+			_overrideId = 1;
 		}
 		_openQueue.empty();
-		_openQueue = Heap<Node>();
+	}
+
+	/*
+		Invalidates the previous search and its cost overrides.
+		The path buffer is kept to be reused by the next search.
+	*/
+	void AStar::CleanMap()
+	{
+		_pathLength = 0;
+		NewSearchId();
+		_overrideId = _searchId;
 	}
 
 	/*
@@ -222,17 +345,40 @@ namespace AI
 		{
 			return false;
 		}
-		_pathLength = 0;																//It's 1 because there's an offset in the loop later.
+		_pathLength = 0;
+		_nrOfExpandedNodes = 0;
+		if (_heuristicType == JUMP_POINT)
+		{
+			int result = FindJumpPointPath();
+			if (result >= 0)
+			{
+				return result == 1;
+			}
+			int expandedNodes = _nrOfExpandedNodes;
+			NewSearchId();																//Found varying tile costs, redo the search as plain octile A*
+			_nrOfExpandedNodes = expandedNodes;
+		}
+		return FindGridPath();
+	}
+
+	/*
+	Regular A* visiting every neighbouring tile.
+	*/
+	bool AStar::FindGridPath()
+	{
 		Vec2D currentPos = _start;
-		_grid[_start._x][_start._y]._open = 2;
+		int goalIndex = GetIndex(_goal);
+		int currentIndex = GetIndex(_start);
+		GetNode(currentIndex)._open = 2;
 
-		while (currentPos != _goal)														//loops until a path has been found
+		while (currentIndex != goalIndex)												//loops until a path has been found
 		{
-			for (int i = 0; i < 8 && (_heuristicType != MANHATTAN || i < 4); i++)		//Manhattan skips diagonals 
+			_nrOfExpandedNodes++;
+			for (int i = 0; i < 8 && (_heuristicType != MANHATTAN || i < 4); i++)		//Manhattan skips diagonals
 			{
 				Vec2D checkedPos = currentPos + NEIGHBOUR_OFFSETS[i];
-				if (IsPositionValid(checkedPos) && _grid[checkedPos._x][checkedPos._y]._open != 2 && _grid[checkedPos._x][checkedPos._y]._tileCost > 0 &&	 //checks for borders and already visited
-					_grid[checkedPos._x][currentPos._y]._tileCost > 0 && _grid[currentPos._x][checkedPos._y]._tileCost > 0)								//checks for corners
+				if (IsPositionValid(checkedPos) && GetNode(GetIndex(checkedPos))._open != 2 && GetCost(GetIndex(checkedPos)) > 0 &&		//checks for borders and already visited
+					GetCost(GetIndex({checkedPos._x, currentPos._y})) > 0 && GetCost(GetIndex({currentPos._x, checkedPos._y})) > 0)		//checks for corners
 				{
 					CalculateHCost(checkedPos);											//As the program works now, h must be calculated before g.
 					CalculateGCost(currentPos, checkedPos);
@@ -244,33 +390,210 @@ namespace AI
 			}
 			else
 			{
-				currentPos = _openQueue.removeMin()._position;
-				while (_grid[currentPos._x][currentPos._y]._open == 2)
+				currentIndex = _openQueue.removeMin();
+				GetNode(currentIndex)._open = 2;
+				currentPos = GetPosition(currentIndex);
+			}
+		}
+		TracePath();
+		return true;
+	}
+
+	/*
+	Jump Point Search. Returns 1 if a path was found, 0 if there is none and -1 if a tile with non-uniform cost
+	was found, in which case the result is not guaranteed to be optimal and the search has to be redone with A*.
+	*/
+	int AStar::FindJumpPointPath()
+	{
+		Vec2D directions[8];
+		int goalIndex = GetIndex(_goal);
+		int currentIndex = GetIndex(_start);
+		GetNode(currentIndex)._open = 2;
+
+		while (currentIndex != goalIndex)
+		{
+			_nrOfExpandedNodes++;
+			Vec2D currentPos = GetPosition(currentIndex);
+			int nrOfDirections = FindJumpDirections(currentPos, directions);
+			for (int i = 0; i < nrOfDirections; i++)
+			{
+				int jumpPoint = -1;
+				if (!Jump(currentPos, directions[i], jumpPoint))
+				{
+					return -1;
+				}
+				if (jumpPoint != -1)
 				{
-					if (_openQueue.size() <= 0)
-					{
-						return false;
-					}
-					currentPos = _openQueue.removeMin()._position;
+					AddJumpPoint(currentIndex, jumpPoint);
 				}
-				_grid[currentPos._x][currentPos._y]._open = 2;
 			}
+			if (_openQueue.size() <= 0)
+			{
+				return 0;
+			}
+			currentIndex = _openQueue.removeMin();
+			GetNode(currentIndex)._open = 2;
+		}
+		TracePath();
+		return 1;
+	}
+
+	/*
+	Finds the directions worth jumping in from a jump point, based on the direction it was reached from.
+	Blocked directions are left for Jump to discard.
+	*/
+	int AStar::FindJumpDirections(Vec2D pos, Vec2D* directions)
+	{
+		int parent = GetNode(GetIndex(pos))._parent;
+		if (parent == -1)																//The start node checks all neighbours
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				directions[i] = NEIGHBOUR_OFFSETS[i];
+			}
+			return 8;
+		}
+		Vec2D offset = pos - GetPosition(parent);
+		Vec2D dir = Vec2D((offset._x > 0) - (offset._x < 0), (offset._y > 0) - (offset._y < 0));
+		int nrOfDirections = 0;
+		if (dir._x != 0 && dir._y != 0)
+		{
+			directions[nrOfDirections++] = dir;
+			directions[nrOfDirections++] = Vec2D(dir._x, 0);
+			directions[nrOfDirections++] = Vec2D(0, dir._y);
 		}
-		while (currentPos != _start)													//traces the route back to start
+		else
 		{
-			_pathLength++;
-			currentPos = _grid[currentPos._x][currentPos._y]._parent->_position;
+			Vec2D side = Vec2D(dir._y, dir._x);										//perpendicular to the movement
+			directions[nrOfDirections++] = dir;
+			directions[nrOfDirections++] = dir + side;
+			directions[nrOfDirections++] = dir - side;
+			directions[nrOfDirections++] = side;
+			directions[nrOfDirections++] = Vec2D(-side._x, -side._y);
+		}
+		return nrOfDirections;
+	}
+
+	/*
+	Moves from a position in a direction until a jump point, a blocked tile or the goal is found.
+	jumpPoint is set to the tile index of the jump point, or -1 if there was none.
+	Returns false if a tile with a cost other than 1 was encountered.
+	*/
+	bool AStar::Jump(Vec2D from, Vec2D dir, int& jumpPoint)
+	{
+		jumpPoint = -1;
+		bool diagonal = dir._x != 0 && dir._y != 0;
+		Vec2D pos = from;
+		while (true)
+		{
+			if (diagonal && (!IsWalkable({pos._x + dir._x, pos._y}) || !IsWalkable({pos._x, pos._y + dir._y})))	//checks for corners
+			{
+				return true;
+			}
+			pos += dir;
+			if (!IsWalkable(pos))
+			{
+				return true;
+			}
+			int index = GetIndex(pos);
+			if (GetCost(index) != 1)													//The goal included, its cost decides between a straight or diagonal last step
+			{
+				return false;
+			}
+			if (pos == _goal)
+			{
+				jumpPoint = index;
+				return true;
+			}
+			if (diagonal)
+			{
+				int straightJumpPoint = -1;
+				if (!Jump(pos, Vec2D(dir._x, 0), straightJumpPoint))
+				{
+					return false;
+				}
+				if (straightJumpPoint == -1 && !Jump(pos, Vec2D(0, dir._y), straightJumpPoint))
+				{
+					return false;
+				}
+				if (straightJumpPoint != -1)
+				{
+					jumpPoint = index;
+					return true;
+				}
+			}
+			else if (HasForcedNeighbour(pos, dir))
+			{
+				jumpPoint = index;
+				return true;
+			}
+		}
+	}
+
+	/*
+	With corners not being cut, a straight move has a forced neighbour when a tile beside it is open
+	while the tile beside the previous position is blocked.
+	*/
+	bool AStar::HasForcedNeighbour(Vec2D pos, Vec2D dir) const
+	{
+		Vec2D side = Vec2D(dir._y, dir._x);
+		Vec2D previous = Vec2D(pos._x - dir._x, pos._y - dir._y);
+		return (IsWalkable({pos._x + side._x, pos._y + side._y}) && !IsWalkable({previous._x + side._x, previous._y + side._y})) ||
+			(IsWalkable({pos._x - side._x, pos._y - side._y}) && !IsWalkable({previous._x - side._x, previous._y - side._y}));
+	}
+
+	void AStar::AddJumpPoint(int parentIndex, int jumpIndex)
+	{
+		Node& node = GetNode(jumpIndex);
+		if (node._open != 2)
+		{
+			Vec2D jumpPos = GetPosition(jumpIndex);
+			float g = GetNode(parentIndex)._gCost + GetHeuristicDistance(GetPosition(parentIndex), jumpPos);		//Every tile between two jump points costs 1
+			if (node._open == 0 || node._gCost > g)
+			{
+				node._open = 1;
+				node._gCost = g;
+				node._hCost = GetHeuristicDistance(jumpPos, _goal) * _hWeight;
+				node._parent = parentIndex;
+				_openQueue.insertOrDecrease(jumpIndex, node._gCost + node._hCost);
+			}
+		}
+	}
+
+	/*
+	Writes the path from the goal back to the start into _path. Parents can be several tiles away, as with jump points,
+	as long as they are on a straight or diagonal line.
+	*/
+	void AStar::TracePath()
+	{
+		int startIndex = GetIndex(_start);
+		int goalIndex = GetIndex(_goal);
+		_pathLength = 0;
+		for (int i = goalIndex; i != startIndex; i = _grid[i]._parent)
+		{
+			Vec2D offset = GetPosition(i) - GetPosition(_grid[i]._parent);
+			_pathLength += std::max(abs(offset._x), abs(offset._y));
+		}
+		if (_pathLength > _pathCapacity)
+		{
+			delete[] _path;
+			_pathCapacity = _pathLength;
+			_path = new Vec2D[_pathCapacity];
 		}
-		_path = new Vec2D[_pathLength];
 		int c = 0;
-		currentPos = _goal;
-		while (currentPos != _start)													//traces the route back to start
+		for (int i = goalIndex; i != startIndex; i = _grid[i]._parent)
 		{
-			_path[c++] = currentPos;
-			currentPos = _grid[currentPos._x][currentPos._y]._parent->_position;
+			Vec2D pos = GetPosition(i);
+			Vec2D parentPos = GetPosition(_grid[i]._parent);
+			Vec2D offset = parentPos - pos;
+			Vec2D step = Vec2D((offset._x > 0) - (offset._x < 0), (offset._y > 0) - (offset._y < 0));
+			while (pos != parentPos)
+			{
+				_path[c++] = pos;
+				pos += step;
+			}
 		}
-	//	_path[c++] = currentPos;														//Excluding start position since it should already be known
-		return true;
+	//	_path[c++] = _start;															//Excluding start position since it should already be known
 	}
 
 
@@ -288,11 +611,11 @@ namespace AI
 				//}
 				//else
 				//{
-					file << (int)_grid[i][j]._tileCost << "\t";
+					file << GetCost(GetIndex({i, j})) << "\t";
 			//	}
 			}
 			file << "\n";
 		}
 		file.close();
 	}
-}
\ No newline at end of file
+}
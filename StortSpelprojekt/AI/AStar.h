@@ -2,7 +2,7 @@
 #include <cmath>
 #include <algorithm>
 #include <fstream>
-#include "Heap.h"
+#include "IndexedHeap.h"
 #include "AIUtil.h"
 
 #define AI_EXPORT __declspec(dllexport)
@@ -17,7 +17,7 @@ namespace AI
 	class AI_EXPORT AStar
 	{
 	public:
-		
+
 
 		/*
 		Different heuristic used for estimating the distance to the goal
@@ -25,71 +25,87 @@ namespace AI
 		CHEBYSHEV: Diagonal movement has a cost of 1
 		OCTILE: Diagonal movement costs sqrt(2)
 		EUCLIDEAN: Calculates the distance in a straight line to the goal.
+		JUMP_POINT: Octile movement using Jump Point Search. Only expands the jump points of uniform cost areas,
+					falls back to regular A* with OCTILE if a tile with a cost other than 1 is found during the search.
 		*/
 		enum Heuristic
 		{
-			MANHATTAN, CHEBYSHEV, OCTILE, EUCLIDEAN
+			MANHATTAN, CHEBYSHEV, OCTILE, EUCLIDEAN, JUMP_POINT
 		};
 	private:
+		/*
+			Search state of a single tile. The state is only valid while _searchId matches the search id of the map,
+			a stale node counts as unvisited and is reset the first time it is touched. That way a new search never
+			has to walk the whole grid.
+		*/
 		struct Node
 		{
-			Vec2D _position;
-			__int8 _open;										//0 = not checked, 1 = open, 2 = closed
-			__int16 _tileCost;									//cost of traversing the individual tile
+			unsigned int _searchId;								//the search the rest of the node belongs to
+			int _parent;										//tile index of the path back to the start node, -1 if none
 			float _gCost, _hCost;								//distance from start and heuristic to goal, respectively
-			Node* _parent;										//the path back to the start node 
+			__int8 _open;										//0 = not checked, 1 = open, 2 = closed
 			Node()
 			{
-				_position = {0, 0};
-				_hCost = -1.0f;
-				_gCost = -1.0f;
+				_searchId = 0;
+				_parent = -1;
+				_gCost = 0.0f;
+				_hCost = 0.0f;
 				_open = 0;
-				_parent = nullptr;
-				_tileCost = 0;
-			}
-			Node(__int16 x, __int16 y, float h = -1.0f)
-			{
-				_position = {x, y};
-				_hCost = h;
-				_gCost = -1.0f;
-				_open = 0;
-				_parent = nullptr;
-				_tileCost = 0;
 			}
 			~Node()
 			{}
-			bool operator<(const Node& comp)
-			{
-				return (_gCost + _hCost) < (comp._gCost + comp._hCost);
-			}
-			bool operator>(const Node& comp)
-			{
-				return (_gCost + _hCost) > (comp._gCost + comp._hCost);
-			}
 		};
 		int _pathLength;
+		int _pathCapacity;
 		Vec2D* _path;											//An ordered array moving from goal to start
 		__int16 _height, _width;
-		Node** _grid;
-		//	std::vector<Node> _openQueue;							//A priority queue for open nodes
-		Heap<Node> _openQueue;
+		Node* _grid;											//Search state, indexed by tile index
+		__int16* _tileCosts;									//cost of traversing the individual tile, indexed by tile index
+		bool _ownsTileCosts;									//false if the costs are shared with other searches
+		unsigned int* _overrideIds;								//Id of the overrides a cost in _overrideCosts belongs to. Only allocated once an override is made
+		unsigned int _overrideId;								//Set to the search id by CleanMap, the overrides made after it are valid
+		__int16* _overrideCosts;								//Costs replacing _tileCosts for the current search
+		unsigned int _searchId;									//Incremented by CleanMap. Nodes with an older id are considered unvisited
+		IndexedHeap<4> _openQueue;								//Tile indices by f-cost, each queued at most once
 		Vec2D _start, _goal;
 		Heuristic _heuristicType;
 		__int8 _hWeight;										//heuristic weight for moving a tile
-		bool IsPositionValid(Vec2D pos);
+		int _nrOfExpandedNodes;									//Nodes taken from the open queue during the last search
+		bool IsPositionValid(Vec2D pos) const;
+		bool IsWalkable(Vec2D pos) const;
+		int GetIndex(Vec2D pos) const;
+		Vec2D GetPosition(int index) const;
+		Node& GetNode(int index);
+		void CreateGrid(__int16* sharedTileCosts = nullptr);
+		void NewSearchId();
+		int GetCost(int index) const
+		{
+			return _overrideIds != nullptr && _overrideIds[index] == _overrideId ? _overrideCosts[index] : _tileCosts[index];
+		}
 		void CalculateHCost(Vec2D pos);
 		void CalculateGCost(Vec2D parentPos, Vec2D currentPos);
+		void TracePath();
+		bool FindGridPath();
+		int FindJumpPointPath();
+		int FindJumpDirections(Vec2D pos, Vec2D* directions);
+		bool Jump(Vec2D from, Vec2D dir, int& jumpPoint);
+		bool HasForcedNeighbour(Vec2D pos, Vec2D dir) const;
+		void AddJumpPoint(int parentIndex, int jumpIndex);
 	public:
 		AStar();
 		AStar(int width, int height, Vec2D start, Vec2D goal, Heuristic heuristic = MANHATTAN, int hWeight = 1);
 		AStar(int width, int height, Heuristic heuristic = MANHATTAN, int hWeight = 1);
+		AStar(int width, int height, __int16* sharedTileCosts, Heuristic heuristic = MANHATTAN, int hWeight = 1);
 		virtual ~AStar();
+		void ShareTileCosts(__int16* sharedTileCosts);				//Switches to other shared costs of the same size, e.g. a snapshot
 		void SetTileCost(Vec2D pos, int cost = 1);
 		void SetStartPosition(Vec2D pos);
 		void SetGoalPosition(Vec2D pos);
+		void SetTileCostOverride(Vec2D pos, int cost);
 		int GetTileCost(Vec2D pos)const;
 		Vec2D* GetPath() const;
 		int GetPathLength() const;
+		int GetNrOfExpandedNodes() const;
 		float GetHeuristicDistance(Vec2D start, Vec2D goal) const;
 		void CleanMap();
 		void Init(Vec2D start, Vec2D goal);
@@ -98,4 +114,4 @@ namespace AI
 		void printMap();
 	};
 
-}
\ No newline at end of file
+}
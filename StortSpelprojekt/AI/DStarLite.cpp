@@ -0,0 +1,292 @@
+#include "DStarLite.h"
+#include <limits>
+
+namespace AI
+{
+	const float UNREACHABLE = std::numeric_limits<float>::infinity();
+	const float KEY_TOLERANCE = 0.001f;			//Tiles on the path may tie with the start, rounding must not leave them unexpanded
+
+	int DStarLite::GetIndex(Vec2D pos) const
+	{
+		return pos._y * _width + pos._x;
+	}
+
+	Vec2D DStarLite::GetPosition(int index) const
+	{
+		return Vec2D(index % _width, index / _width);
+	}
+
+	bool DStarLite::IsPositionValid(Vec2D pos) const
+	{
+		return pos._x >= 0 && pos._x < _width && pos._y >= 0 && pos._y < _height;
+	}
+
+	float DStarLite::GetStepCost(Vec2D from, Vec2D to) const
+	{
+		if (!IsPositionValid(to) || _tileCosts[GetIndex(to)] <= 0)
+		{
+			return -1.0f;
+		}
+		if (from._x == to._x || from._y == to._y)
+		{
+			return _tileCosts[GetIndex(to)];
+		}
+		if (_tileCosts[GetIndex({to._x, from._y})] <= 0 || _tileCosts[GetIndex({from._x, to._y})] <= 0)	//checks for corners
+		{
+			return -1.0f;
+		}
+		return SQRT2 * _tileCosts[GetIndex(to)];
+	}
+
+	DStarLite::OpenNode DStarLite::CalculateKey(int index) const
+	{
+		float cost = _g[index] < _rhs[index] ? _g[index] : _rhs[index];
+		return OpenNode(index, cost + GetOctileDistance(_start, GetPosition(index)) + _keyModifier, cost);
+	}
+
+	/*
+	Recalculates the lookahead of the tile from its neighbours and queues it if it no longer matches _g
+	*/
+	void DStarLite::UpdateTile(Vec2D pos)
+	{
+		int index = GetIndex(pos);
+		if (pos != _goal)
+		{
+			_rhs[index] = UNREACHABLE;
+			for (int i = 0; i < 8; i++)
+			{
+				Vec2D neighbour = pos + NEIGHBOUR_OFFSETS[i];
+				float stepCost = GetStepCost(pos, neighbour);
+				if (stepCost >= 0.0f && _g[GetIndex(neighbour)] + stepCost < _rhs[index])
+				{
+					_rhs[index] = _g[GetIndex(neighbour)] + stepCost;
+				}
+			}
+		}
+		if (_g[index] != _rhs[index])
+		{
+			_openQueue.insert(CalculateKey(index));
+		}
+	}
+
+	/*
+	Expands tiles until the start is up to date. Only tiles whose cost to the goal may have changed are in the queue,
+	so after a small change this stops long before the whole map has been searched.
+	*/
+	void DStarLite::ComputeShortestPath()
+	{
+		int startIndex = GetIndex(_start);
+		while (_openQueue.size() > 0)
+		{
+			OpenNode current = _openQueue.getMin();
+			OpenNode startKey = CalculateKey(startIndex);
+			startKey._k1 += KEY_TOLERANCE;
+			if (!(current < startKey) && _g[startIndex] == _rhs[startIndex])
+			{
+				break;
+			}
+			_openQueue.removeMin();
+			int index = current._index;
+			if (_g[index] == _rhs[index])												//Outdated entry
+			{
+				continue;
+			}
+			OpenNode key = CalculateKey(index);
+			if (current < key)															//Queued before the start moved
+			{
+				_openQueue.insert(key);
+				continue;
+			}
+			_nrOfExpandedNodes++;
+			Vec2D pos = GetPosition(index);
+			if (_g[index] > _rhs[index])
+			{
+				_g[index] = _rhs[index];
+			}
+			else
+			{
+				_g[index] = UNREACHABLE;
+				UpdateTile(pos);
+			}
+			for (int i = 0; i < 8; i++)
+			{
+				Vec2D neighbour = pos + NEIGHBOUR_OFFSETS[i];
+				if (IsPositionValid(neighbour))
+				{
+					UpdateTile(neighbour);
+				}
+			}
+		}
+	}
+
+	bool DStarLite::TracePath()
+	{
+		_pathLength = 0;
+		if (_g[GetIndex(_start)] == UNREACHABLE)
+		{
+			return false;
+		}
+		for (int pass = 0; pass < 2; pass++)										//Counts the tiles first, then writes them from the back
+		{
+			Vec2D pos = _start;
+			int c = _pathLength;
+			while (pos != _goal)
+			{
+				Vec2D next = pos;
+				float nextCost = UNREACHABLE;
+				for (int i = 0; i < 8; i++)
+				{
+					Vec2D neighbour = pos + NEIGHBOUR_OFFSETS[i];
+					float stepCost = GetStepCost(pos, neighbour);
+					if (stepCost >= 0.0f && _g[GetIndex(neighbour)] + stepCost < nextCost)
+					{
+						next = neighbour;
+						nextCost = _g[GetIndex(neighbour)] + stepCost;
+					}
+				}
+				if (next == pos || (pass == 0 && _pathLength >= _width * _height))	//Can only happen if the search state is broken
+				{
+					_pathLength = 0;
+					return false;
+				}
+				pos = next;
+				if (pass == 0)
+				{
+					_pathLength++;
+				}
+				else
+				{
+					_path[--c] = pos;
+				}
+			}
+			if (pass == 0 && _pathLength > _pathCapacity)
+			{
+				delete[] _path;
+				_pathCapacity = _pathLength;
+				_path = new Vec2D[_pathCapacity];
+			}
+		}
+		return true;
+	}
+
+	DStarLite::DStarLite(int width, int height, const __int16* tileCosts)
+	{
+		_width = width;
+		_height = height;
+		_tileCosts = new __int16[width * height];
+		_g = new float[width * height];
+		_rhs = new float[width * height];
+		for (int i = 0; i < width * height; i++)
+		{
+			_tileCosts[i] = tileCosts[i];
+			_g[i] = UNREACHABLE;
+			_rhs[i] = UNREACHABLE;
+		}
+		_keyModifier = 0.0f;
+		_pathLength = 0;
+		_pathCapacity = 0;
+		_path = nullptr;
+		_nrOfExpandedNodes = 0;
+	}
+
+	DStarLite::~DStarLite()
+	{
+		delete[] _tileCosts;
+		delete[] _g;
+		delete[] _rhs;
+		delete[] _path;
+	}
+
+	void DStarLite::Init(Vec2D start, Vec2D goal)
+	{
+		for (int i = 0; i < _width * _height; i++)
+		{
+			_g[i] = UNREACHABLE;
+			_rhs[i] = UNREACHABLE;
+		}
+		_openQueue.empty();
+		_start = start;
+		_goal = goal;
+		_keyModifier = 0.0f;
+		_pathLength = 0;
+		_rhs[GetIndex(goal)] = 0.0f;
+		_openQueue.insert(CalculateKey(GetIndex(goal)));
+	}
+
+	/*
+	Keys already in the queue were calculated from the old start. Instead of recalculating them all, the distance moved
+	is added to every new key, which keeps the old ones from being too high.
+	*/
+	void DStarLite::SetStartPosition(Vec2D pos)
+	{
+		_keyModifier += GetOctileDistance(_start, pos);
+		_start = pos;
+	}
+
+	void DStarLite::SetTileCosts(const __int16* tileCosts)
+	{
+		for (int i = 0; i < _width * _height; i++)
+		{
+			_tileCosts[i] = tileCosts[i];
+			_g[i] = UNREACHABLE;
+			_rhs[i] = UNREACHABLE;
+		}
+		_openQueue.empty();
+		_keyModifier = 0.0f;
+		_pathLength = 0;
+	}
+
+	void DStarLite::SetTileCost(Vec2D pos, int cost)
+	{
+		if (_tileCosts[GetIndex(pos)] == cost)
+		{
+			return;
+		}
+		_tileCosts[GetIndex(pos)] = cost;
+		for (int i = 0; i < 8; i++)														//Only steps onto the tile, or past its corners, got more or less expensive
+		{
+			Vec2D neighbour = pos + NEIGHBOUR_OFFSETS[i];
+			if (IsPositionValid(neighbour))
+			{
+				UpdateTile(neighbour);
+			}
+		}
+	}
+
+	int DStarLite::GetTileCost(Vec2D pos) const
+	{
+		return _tileCosts[GetIndex(pos)];
+	}
+
+	Vec2D DStarLite::GetGoal() const
+	{
+		return _goal;
+	}
+
+	Vec2D* DStarLite::GetPath() const
+	{
+		return _path;
+	}
+
+	int DStarLite::GetPathLength() const
+	{
+		return _pathLength;
+	}
+
+	int DStarLite::GetNrOfExpandedNodes() const
+	{
+		return _nrOfExpandedNodes;
+	}
+
+	bool DStarLite::FindPath()
+	{
+		_nrOfExpandedNodes = 0;
+		if (_goal == _start)															//Same as AStar, there is no path to walk
+		{
+			_pathLength = 0;
+			return false;
+		}
+		ComputeShortestPath();
+		return TracePath();
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "Heap.h"
+#include "AIUtil.h"
+
+#define AI_EXPORT __declspec(dllexport)
+
+namespace AI
+{
+	/*
+		Incremental planner (D* Lite) for a unit that keeps walking towards the same goal while the map changes.
+		Searches backwards from the goal and keeps its search state between calls. Changing a tile cost only
+		queues the tiles next to it, and the next FindPath repairs the costs the change actually affects instead
+		of searching the whole map again. The start may move along the path without invalidating anything.
+		Uses the same costs and corner rule as AStar with OCTILE, on its own copy of the tile costs.
+	*/
+	class AI_EXPORT DStarLite
+	{
+	private:
+		/*
+			The two part priority of a tile in the open queue, compared first by _k1 and then by _k2
+		*/
+		struct OpenNode
+		{
+			int _index;
+			float _k1, _k2;
+			OpenNode()
+			{
+				_index = -1;
+				_k1 = 0.0f;
+				_k2 = 0.0f;
+			}
+			OpenNode(int index, float k1, float k2)
+			{
+				_index = index;
+				_k1 = k1;
+				_k2 = k2;
+			}
+			bool operator<(const OpenNode& comp)
+			{
+				return _k1 < comp._k1 || (_k1 == comp._k1 && _k2 < comp._k2);
+			}
+			bool operator>(const OpenNode& comp)
+			{
+				return _k1 > comp._k1 || (_k1 == comp._k1 && _k2 > comp._k2);
+			}
+		};
+		__int16 _width, _height;
+		__int16* _tileCosts;									//cost of entering the tile, <= 0 if unwalkable
+		float* _g;												//cost from the tile to the goal as of the last expansion, infinite if unknown
+		float* _rhs;											//one step lookahead of _g. The tile is in the open queue while they differ
+		Heap<OpenNode> _openQueue;								//May hold outdated entries, those are skipped when removed
+		Vec2D _start, _goal;
+		float _keyModifier;										//Sum of the distances the start has moved, added to new keys
+		int _pathLength;
+		int _pathCapacity;
+		Vec2D* _path;											//An ordered array moving from goal to start
+		int _nrOfExpandedNodes;									//Tiles taken from the open queue during the last search
+
+		int GetIndex(Vec2D pos) const;
+		Vec2D GetPosition(int index) const;
+		bool IsPositionValid(Vec2D pos) const;
+		float GetStepCost(Vec2D from, Vec2D to) const;			//Negative if the step can't be taken
+		OpenNode CalculateKey(int index) const;
+		void UpdateTile(Vec2D pos);
+		void ComputeShortestPath();
+		bool TracePath();										//Follows the cheapest neighbours from the start
+
+		DStarLite(const DStarLite&) = delete;
+		DStarLite& operator=(const DStarLite&) = delete;
+	public:
+		DStarLite(int width, int height, const __int16* tileCosts);
+		virtual ~DStarLite();
+
+		/*
+			Throws away the search state and starts over towards a new goal
+		*/
+		void Init(Vec2D start, Vec2D goal);
+		void SetStartPosition(Vec2D pos);
+		/*
+			The change is repaired during the next FindPath
+		*/
+		void SetTileCost(Vec2D pos, int cost);
+		/*
+			Replaces every tile cost with a copy of tileCosts, sized like the map, and throws away the search state.
+			Init must be called before the next FindPath
+		*/
+		void SetTileCosts(const __int16* tileCosts);
+		int GetTileCost(Vec2D pos) const;
+		Vec2D GetGoal() const;
+		Vec2D* GetPath() const;
+		int GetPathLength() const;
+		int GetNrOfExpandedNodes() const;
+		/*
+			Brings the search up to date and traces the path from the start, ordered like AStar
+		*/
+		bool FindPath();
+	};
+}
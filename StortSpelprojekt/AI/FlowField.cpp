@@ -0,0 +1,115 @@
+#include "FlowField.h"
+
+namespace AI
+{
+	const __int8 OPPOSITE_OFFSET[8] = {1, 0, 3, 2, 7, 6, 5, 4};		//Index in NEIGHBOUR_OFFSETS of the opposite direction
+
+	int FlowField::GetIndex(Vec2D pos) const
+	{
+		return pos._y * _width + pos._x;
+	}
+
+	FlowField::FlowField(int width, int height, Vec2D goal)
+	{
+		_width = width;
+		_height = height;
+		_goal = goal;
+		_costs = new float[width * height];
+		_directions = new __int8[width * height];
+		_nrOfSteps = new __int16[width * height];
+		_costVersion = 0;
+		for (int i = 0; i < width * height; i++)
+		{
+			_costs[i] = -1.0f;
+			_directions[i] = -1;
+			_nrOfSteps[i] = 0;
+		}
+		_openQueue.setCapacity(width * height);
+	}
+
+	FlowField::~FlowField()
+	{
+		delete[] _costs;
+		delete[] _directions;
+		delete[] _nrOfSteps;
+	}
+
+	/*
+		Searches outwards from the goal. A tile is given the direction to the neighbour it was reached from,
+		so walking the directions retraces the cheapest path.
+	*/
+	void FlowField::Build(const __int16* tileCosts, unsigned int costVersion)
+	{
+		for (int i = 0; i < _width * _height; i++)
+		{
+			_costs[i] = -1.0f;
+			_directions[i] = -1;
+			_nrOfSteps[i] = 0;
+		}
+		_costVersion = costVersion;
+		_openQueue.empty();
+		int goalIndex = GetIndex(_goal);
+		_costs[goalIndex] = 0.0f;
+		_openQueue.insert(goalIndex, 0.0f);
+
+		while (_openQueue.size() > 0)
+		{
+			int currentIndex = _openQueue.removeMin();
+			Vec2D currentPos = Vec2D(currentIndex % _width, currentIndex / _width);
+			float tileCost = tileCosts[currentIndex] > 0 ? tileCosts[currentIndex] : 1.0f;		//Only the goal can be unwalkable
+			for (int i = 0; i < 8; i++)
+			{
+				Vec2D checkedPos = currentPos + NEIGHBOUR_OFFSETS[i];
+				if (checkedPos._x < 0 || checkedPos._x >= _width || checkedPos._y < 0 || checkedPos._y >= _height ||
+					tileCosts[GetIndex(checkedPos)] <= 0 || tileCosts[GetIndex({checkedPos._x, currentPos._y})] <= 0 || tileCosts[GetIndex({currentPos._x, checkedPos._y})] <= 0)	//checks for walls and corners
+				{
+					continue;
+				}
+				int checkedIndex = GetIndex(checkedPos);
+				float cost = _costs[currentIndex] + (i < 4 ? tileCost : SQRT2 * tileCost);		//Moving from the checked tile costs as much as entering the current
+				if (_costs[checkedIndex] < 0.0f || _costs[checkedIndex] > cost)
+				{
+					_costs[checkedIndex] = cost;
+					_directions[checkedIndex] = OPPOSITE_OFFSET[i];
+					_nrOfSteps[checkedIndex] = _nrOfSteps[currentIndex] + 1;
+					_openQueue.insertOrDecrease(checkedIndex, cost);
+				}
+			}
+		}
+	}
+
+	Vec2D FlowField::GetGoal() const
+	{
+		return _goal;
+	}
+
+	unsigned int FlowField::GetCostVersion() const
+	{
+		return _costVersion;
+	}
+
+	bool FlowField::IsReachable(Vec2D pos) const
+	{
+		return pos._x >= 0 && pos._x < _width && pos._y >= 0 && pos._y < _height && _costs[GetIndex(pos)] >= 0.0f;
+	}
+
+	float FlowField::GetCost(Vec2D pos) const
+	{
+		return _costs[GetIndex(pos)];
+	}
+
+	int FlowField::GetNrOfSteps(Vec2D pos) const
+	{
+		return _nrOfSteps[GetIndex(pos)];
+	}
+
+	Vec2D FlowField::GetNextTile(Vec2D pos) const
+	{
+		__int8 direction = _directions[GetIndex(pos)];
+		if (direction == -1)
+		{
+			return pos;
+		}
+		return pos + NEIGHBOUR_OFFSETS[(int)direction];
+	}
+}
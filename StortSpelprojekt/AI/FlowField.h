@@ -0,0 +1,41 @@
+#pragma once
+#include "IndexedHeap.h"
+#include "AIUtil.h"
+
+#define AI_EXPORT __declspec(dllexport)
+
+namespace AI
+{
+	/*
+		Dijkstra map towards a single goal, shared by every unit heading there.
+		Stores the cost to the goal and the best direction for every tile, so following it is a lookup per tile.
+		Uses the same costs and corner rule as AStar with OCTILE. The goal itself may be unwalkable, e.g. loot on furniture.
+	*/
+	class AI_EXPORT FlowField
+	{
+	private:
+		__int16 _width, _height;
+		Vec2D _goal;
+		float* _costs;										//Cost from the tile to the goal, -1 if unreachable
+		__int8* _directions;								//Index in NEIGHBOUR_OFFSETS of the next tile, -1 at the goal and on unreachable tiles
+		__int16* _nrOfSteps;								//Tiles left to walk from the tile
+		unsigned int _costVersion;							//Version of the tile costs the field was built from
+		IndexedHeap<4> _openQueue;							//Tile indices by cost
+
+		int GetIndex(Vec2D pos) const;
+	public:
+		FlowField(int width, int height, Vec2D goal);
+		virtual ~FlowField();
+
+		/*
+			Builds the field from the tile costs, which are indexed by y * width + x and <= 0 if unwalkable
+		*/
+		void Build(const __int16* tileCosts, unsigned int costVersion);
+		Vec2D GetGoal() const;
+		unsigned int GetCostVersion() const;
+		bool IsReachable(Vec2D pos) const;
+		float GetCost(Vec2D pos) const;
+		int GetNrOfSteps(Vec2D pos) const;
+		Vec2D GetNextTile(Vec2D pos) const;				//Returns pos itself at the goal or if the goal can't be reached
+	};
+}
@@ -0,0 +1,454 @@
+#include "HPAStar.h"
+
+namespace AI
+{
+	bool HPAStar::IsPositionValid(Vec2D pos) const
+	{
+		return pos._x >= 0 && pos._x < _width && pos._y >= 0 && pos._y < _height;
+	}
+
+	bool HPAStar::IsWalkable(Vec2D pos) const
+	{
+		return IsPositionValid(pos) && _tileCosts[GetIndex(pos)] > 0;
+	}
+
+	int HPAStar::GetIndex(Vec2D pos) const
+	{
+		return pos._y * _width + pos._x;
+	}
+
+	Vec2D HPAStar::GetPosition(int index) const
+	{
+		return Vec2D(index % _width, index / _width);
+	}
+
+	int HPAStar::GetClusterIndex(Vec2D pos) const
+	{
+		return (pos._y / _clusterSize) * _clustersX + pos._x / _clusterSize;
+	}
+
+	int HPAStar::GetLocalIndex(const Cluster& cluster, Vec2D pos) const
+	{
+		return (pos._y - cluster._origin._y) * cluster._width + pos._x - cluster._origin._x;
+	}
+
+	//Returns the node at the index, resetting it first if it belongs to an earlier search
+	HPAStar::Node& HPAStar::GetNode(int index)
+	{
+		Node& node = _nodes[index];
+		if (node._searchId != _searchId)
+		{
+			node._searchId = _searchId;
+			node._parent = -1;
+			node._gCost = 0.0f;
+			node._open = 0;
+		}
+		return node;
+	}
+
+	void HPAStar::NewSearch()
+	{
+		_searchId++;
+		if (_searchId == 0)															//Wrapped around, every stamp is ambiguous
+		{
+			for (int i = 0; i < _width * _height; i++)
+			{
+				_nodes[i]._searchId = 0;
+			}
+			_searchId = 1;
+		}
+		_openQueue.empty();
+	}
+
+	/*
+		Collects the entrance tiles of a cluster from all four of its borders
+	*/
+	void HPAStar::FindEntrances(int clusterIndex, std::vector<int>& entrances) const
+	{
+		const Cluster& cluster = _clusters[clusterIndex];
+		Vec2D topLeft = cluster._origin;
+		Vec2D bottomRight = Vec2D(topLeft._x + cluster._width - 1, topLeft._y + cluster._height - 1);
+		entrances.clear();
+		if (topLeft._x > 0)
+		{
+			FindBorderEntrances(topLeft, Vec2D(topLeft._x - 1, topLeft._y), Vec2D(0, 1), cluster._height, entrances);
+		}
+		if (bottomRight._x < _width - 1)
+		{
+			FindBorderEntrances(Vec2D(bottomRight._x, topLeft._y), Vec2D(bottomRight._x + 1, topLeft._y), Vec2D(0, 1), cluster._height, entrances);
+		}
+		if (topLeft._y > 0)
+		{
+			FindBorderEntrances(topLeft, Vec2D(topLeft._x, topLeft._y - 1), Vec2D(1, 0), cluster._width, entrances);
+		}
+		if (bottomRight._y < _height - 1)
+		{
+			FindBorderEntrances(Vec2D(topLeft._x, bottomRight._y), Vec2D(topLeft._x, bottomRight._y + 1), Vec2D(1, 0), cluster._width, entrances);
+		}
+	}
+
+	/*
+		Walks along one border. Every run of tiles that are walkable on both sides becomes an entrance,
+		with a transition in the middle of short runs and at both ends of long ones.
+		The neighbouring cluster walks the same border and ends up with the matching tiles on its side.
+	*/
+	void HPAStar::FindBorderEntrances(Vec2D inside, Vec2D outside, Vec2D step, int length, std::vector<int>& entrances) const
+	{
+		int runStart = -1;
+		for (int i = 0; i <= length; i++)
+		{
+			bool open = i < length && IsWalkable(inside + step * i) && IsWalkable(outside + step * i);
+			if (open && runStart == -1)
+			{
+				runStart = i;
+			}
+			else if (!open && runStart != -1)
+			{
+				int transitions[2] = {(runStart + i - 1) / 2, -1};
+				if (i - runStart >= MIN_SPLIT_ENTRANCE_LENGTH)
+				{
+					transitions[0] = runStart;
+					transitions[1] = i - 1;
+				}
+				for (int j = 0; j < 2 && transitions[j] != -1; j++)
+				{
+					int index = GetIndex(inside + step * transitions[j]);
+					if (std::find(entrances.begin(), entrances.end(), index) == entrances.end())		//Corner tiles can be on two borders
+					{
+						entrances.push_back(index);
+					}
+				}
+				runStart = -1;
+			}
+		}
+	}
+
+	/*
+		Precomputes the cost between every pair of entrances in a cluster, only moving inside the cluster
+	*/
+	void HPAStar::CalculateCosts(int clusterIndex)
+	{
+		Cluster& cluster = _clusters[clusterIndex];
+		int nrOfEntrances = (int)cluster._entrances.size();
+		cluster._costs.assign(nrOfEntrances * nrOfEntrances, -1.0f);
+		for (int i = 0; i < nrOfEntrances; i++)
+		{
+			FindCostsInCluster(clusterIndex, GetPosition(cluster._entrances[i]), false, _entranceCosts);
+			for (int j = 0; j < nrOfEntrances; j++)
+			{
+				cluster._costs[i * nrOfEntrances + j] = _entranceCosts[GetLocalIndex(cluster, GetPosition(cluster._entrances[j]))];
+			}
+		}
+		cluster._dirty = false;
+	}
+
+	/*
+		Dijkstra search limited to one cluster, using the same costs and corner rule as AStar with OCTILE.
+		Writes the cost from the source to every tile of the cluster, or from every tile to the source if reverse is set.
+		Unreachable tiles get a cost of -1.
+	*/
+	void HPAStar::FindCostsInCluster(int clusterIndex, Vec2D source, bool reverse, float* costs)
+	{
+		const Cluster& cluster = _clusters[clusterIndex];
+		for (int i = 0; i < cluster._width * cluster._height; i++)
+		{
+			costs[i] = -1.0f;
+		}
+		NewSearch();
+		int sourceIndex = GetIndex(source);
+		GetNode(sourceIndex)._open = 1;
+		_openQueue.insert(OpenNode(sourceIndex, 0.0f));
+
+		while (_openQueue.size() > 0)
+		{
+			int currentIndex = _openQueue.removeMin()._index;
+			Node& current = GetNode(currentIndex);
+			if (current._open == 2)
+			{
+				continue;
+			}
+			current._open = 2;
+			Vec2D currentPos = GetPosition(currentIndex);
+			costs[GetLocalIndex(cluster, currentPos)] = current._gCost;
+
+			for (int i = 0; i < 8; i++)
+			{
+				Vec2D checkedPos = currentPos + NEIGHBOUR_OFFSETS[i];
+				if (checkedPos._x < cluster._origin._x || checkedPos._x >= cluster._origin._x + cluster._width ||
+					checkedPos._y < cluster._origin._y || checkedPos._y >= cluster._origin._y + cluster._height ||
+					!IsWalkable(checkedPos) || !IsWalkable({checkedPos._x, currentPos._y}) || !IsWalkable({currentPos._x, checkedPos._y}))	//checks for borders and corners
+				{
+					continue;
+				}
+				int checkedIndex = GetIndex(checkedPos);
+				Node& checked = GetNode(checkedIndex);
+				if (checked._open == 2)
+				{
+					continue;
+				}
+				int enteredIndex = reverse ? currentIndex : checkedIndex;								//Reversed, the search moves from the checked tile to the current
+				float tileCost = _tileCosts[enteredIndex] > 0 ? _tileCosts[enteredIndex] : 1.0f;		//Only the source can be unwalkable
+				float g = current._gCost + (i < 4 ? tileCost : SQRT2 * tileCost);
+				if (checked._open == 0 || checked._gCost > g)
+				{
+					checked._open = 1;
+					checked._gCost = g;
+					_openQueue.insert(OpenNode(checkedIndex, g));
+				}
+			}
+		}
+	}
+
+	void HPAStar::Relax(int fromIndex, int toIndex, float cost, Vec2D goal)
+	{
+		Node& to = GetNode(toIndex);
+		float g = GetNode(fromIndex)._gCost + cost;
+		if (to._open != 2 && (to._open == 0 || to._gCost > g))
+		{
+			Vec2D pos = GetPosition(toIndex);
+			short x = abs(goal._x - pos._x);
+			short y = abs(goal._y - pos._y);
+			to._open = 1;
+			to._gCost = g;
+			to._parent = fromIndex;
+			_openQueue.insert(OpenNode(toIndex, g + SQRT2 * std::min(x, y) + abs(x - y)));
+		}
+	}
+
+	/*
+		Rebuilds the dirty clusters. A dirty cluster can move the entrances of its neighbours,
+		which are then rebuilt as well.
+	*/
+	void HPAStar::Rebuild()
+	{
+		if (!_dirty)
+		{
+			return;
+		}
+		int nrOfClusters = _clustersX * _clustersY;
+		std::vector<int> entrances;
+		std::vector<int> changedNeighbours;
+		for (int i = 0; i < nrOfClusters; i++)
+		{
+			if (_clusters[i]._dirty)
+			{
+				int x = i % _clustersX;
+				int y = i / _clustersX;
+				int neighbours[4] = {x > 0 ? i - 1 : -1, x < _clustersX - 1 ? i + 1 : -1, y > 0 ? i - _clustersX : -1, y < _clustersY - 1 ? i + _clustersX : -1};
+				for (int j = 0; j < 4; j++)
+				{
+					if (neighbours[j] != -1 && !_clusters[neighbours[j]]._dirty)
+					{
+						FindEntrances(neighbours[j], entrances);
+						if (entrances != _clusters[neighbours[j]]._entrances)
+						{
+							changedNeighbours.push_back(neighbours[j]);
+						}
+					}
+				}
+			}
+		}
+		for (unsigned int i = 0; i < changedNeighbours.size(); i++)
+		{
+			_clusters[changedNeighbours[i]]._dirty = true;
+		}
+
+		for (int i = 0; i < nrOfClusters; i++)
+		{
+			if (_clusters[i]._dirty)
+			{
+				std::vector<int>& clusterEntrances = _clusters[i]._entrances;
+				for (unsigned int j = 0; j < clusterEntrances.size(); j++)
+				{
+					_entranceSlot[clusterEntrances[j]] = -1;
+				}
+				FindEntrances(i, clusterEntrances);
+				for (unsigned int j = 0; j < clusterEntrances.size(); j++)
+				{
+					_entranceSlot[clusterEntrances[j]] = j;
+				}
+				CalculateCosts(i);
+			}
+		}
+		_dirty = false;
+	}
+
+	HPAStar::HPAStar(int width, int height, int clusterSize)
+	{
+		_width = width;
+		_height = height;
+		_clusterSize = clusterSize;
+		_clustersX = (width + clusterSize - 1) / clusterSize;
+		_clustersY = (height + clusterSize - 1) / clusterSize;
+		_tileCosts = new __int16[width * height];
+		_entranceSlot = new int[width * height];
+		_nodes = new Node[width * height];
+		for (int i = 0; i < width * height; i++)
+		{
+			_tileCosts[i] = 1;
+			_entranceSlot[i] = -1;
+		}
+		_clusters = new Cluster[_clustersX * _clustersY];
+		for (int i = 0; i < _clustersX * _clustersY; i++)
+		{
+			Cluster& cluster = _clusters[i];
+			cluster._origin = Vec2D((i % _clustersX) * clusterSize, (i / _clustersX) * clusterSize);
+			cluster._width = std::min(clusterSize, width - cluster._origin._x);
+			cluster._height = std::min(clusterSize, height - cluster._origin._y);
+		}
+		_dirty = true;
+		_searchId = 1;
+		_startCosts = new float[clusterSize * clusterSize];
+		_goalCosts = new float[clusterSize * clusterSize];
+		_entranceCosts = new float[clusterSize * clusterSize];
+		_path = nullptr;
+		_pathLength = 0;
+		_pathCapacity = 0;
+		_pathCost = 0.0f;
+	}
+
+	HPAStar::~HPAStar()
+	{
+		delete[] _tileCosts;
+		delete[] _entranceSlot;
+		delete[] _nodes;
+		delete[] _clusters;
+		delete[] _startCosts;
+		delete[] _goalCosts;
+		delete[] _entranceCosts;
+		delete[] _path;
+	}
+
+	void HPAStar::SetTileCost(Vec2D pos, int cost)
+	{
+		int index = GetIndex(pos);
+		if (_tileCosts[index] != cost)
+		{
+			_tileCosts[index] = cost;
+			_clusters[GetClusterIndex(pos)]._dirty = true;
+			_dirty = true;
+		}
+	}
+
+	int HPAStar::GetTileCost(Vec2D pos) const
+	{
+		return _tileCosts[GetIndex(pos)];
+	}
+
+	int HPAStar::GetClusterSize() const
+	{
+		return _clusterSize;
+	}
+
+	Vec2D* HPAStar::GetPath() const
+	{
+		return _path;
+	}
+
+	int HPAStar::GetPathLength() const
+	{
+		return _pathLength;
+	}
+
+	float HPAStar::GetPathCost() const
+	{
+		return _pathCost;
+	}
+
+	/*
+		The start and goal are connected to the entrances of their clusters for the duration of the search,
+		then A* runs on the entrances.
+	*/
+	bool HPAStar::FindPath(Vec2D start, Vec2D goal)
+	{
+		_pathLength = 0;
+		_pathCost = 0.0f;
+		if (start == goal || !IsPositionValid(start) || !IsPositionValid(goal))
+		{
+			return false;
+		}
+		Rebuild();
+
+		int startCluster = GetClusterIndex(start);
+		int goalCluster = GetClusterIndex(goal);
+		FindCostsInCluster(startCluster, start, false, _startCosts);
+		FindCostsInCluster(goalCluster, goal, true, _goalCosts);
+
+		NewSearch();
+		int startIndex = GetIndex(start);
+		int goalIndex = GetIndex(goal);
+		GetNode(startIndex)._open = 1;
+		_openQueue.insert(OpenNode(startIndex, 0.0f));
+		bool found = false;
+		while (_openQueue.size() > 0 && !found)
+		{
+			int currentIndex = _openQueue.removeMin()._index;
+			Node& current = GetNode(currentIndex);
+			if (current._open == 2)
+			{
+				continue;
+			}
+			current._open = 2;
+			if (currentIndex == goalIndex)
+			{
+				found = true;
+				continue;
+			}
+			Vec2D currentPos = GetPosition(currentIndex);
+			int clusterIndex = GetClusterIndex(currentPos);
+			const Cluster& cluster = _clusters[clusterIndex];
+			int slot = _entranceSlot[currentIndex];
+			int nrOfEntrances = (int)cluster._entrances.size();
+
+			//Other entrances of the same cluster
+			for (int i = 0; i < nrOfEntrances; i++)
+			{
+				float cost = currentIndex == startIndex ? _startCosts[GetLocalIndex(cluster, GetPosition(cluster._entrances[i]))] :
+					cluster._costs[slot * nrOfEntrances + i];
+				if (cost > 0.0f)
+				{
+					Relax(currentIndex, cluster._entrances[i], cost, goal);
+				}
+			}
+			//The goal
+			if (clusterIndex == goalCluster && _goalCosts[GetLocalIndex(cluster, currentPos)] > 0.0f)
+			{
+				Relax(currentIndex, goalIndex, _goalCosts[GetLocalIndex(cluster, currentPos)], goal);
+			}
+			//Entrances on the other side of the border
+			if (slot != -1)
+			{
+				for (int i = 0; i < 4; i++)
+				{
+					Vec2D checkedPos = currentPos + NEIGHBOUR_OFFSETS[i];
+					if (IsPositionValid(checkedPos) && _entranceSlot[GetIndex(checkedPos)] != -1 && GetClusterIndex(checkedPos) != clusterIndex)
+					{
+						Relax(currentIndex, GetIndex(checkedPos), _tileCosts[GetIndex(checkedPos)], goal);
+					}
+				}
+			}
+		}
+		if (!found)
+		{
+			return false;
+		}
+
+		for (int i = goalIndex; i != startIndex; i = _nodes[i]._parent)
+		{
+			_pathLength++;
+		}
+		if (_pathLength > _pathCapacity)
+		{
+			delete[] _path;
+			_pathCapacity = _pathLength;
+			_path = new Vec2D[_pathCapacity];
+		}
+		int c = 0;
+		for (int i = goalIndex; i != startIndex; i = _nodes[i]._parent)
+		{
+			_path[c++] = GetPosition(i);
+		}
+		_pathCost = _nodes[goalIndex]._gCost;
+		return true;
+	}
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include "Heap.h"
+#include "AIUtil.h"
+
+#define AI_EXPORT __declspec(dllexport)
+
+namespace AI
+{
+	/*
+		Hierarchical pathfinding (HPA*) for long trips on large maps.
+		The map is split into square clusters. Entrances are placed where two neighbouring clusters share walkable
+		border tiles, and the cheapest way between every pair of entrances inside a cluster is precomputed.
+		A search then only runs on the small graph of entrances, the result being a list of waypoints that are
+		refined one segment at a time with a regular AStar.
+		Changing a tile cost only marks its cluster as dirty. Dirty clusters are rebuilt before the next search.
+	*/
+	class AI_EXPORT HPAStar
+	{
+	private:
+		/*
+			A square part of the map together with its entrances and the costs between them
+		*/
+		struct Cluster
+		{
+			Vec2D _origin;										//top left tile
+			__int16 _width, _height;							//clusters on the right and bottom edge of the map can be smaller
+			std::vector<int> _entrances;						//tile indices of the entrance tiles inside the cluster
+			std::vector<float> _costs;							//_entrances.size()^2 costs from one entrance to another, -1 if unreachable
+			bool _dirty;
+			Cluster()
+			{
+				_width = 0;
+				_height = 0;
+				_dirty = true;
+			}
+			~Cluster()
+			{}
+		};
+		/*
+			Search state of a tile, used both by the abstract search and by the searches inside a cluster
+		*/
+		struct Node
+		{
+			unsigned int _searchId;
+			int _parent;
+			float _gCost;
+			__int8 _open;										//0 = not checked, 1 = open, 2 = closed
+			Node()
+			{
+				_searchId = 0;
+				_parent = -1;
+				_gCost = 0.0f;
+				_open = 0;
+			}
+			~Node()
+			{}
+		};
+		struct OpenNode
+		{
+			int _index;
+			float _fCost;
+			OpenNode()
+			{
+				_index = -1;
+				_fCost = 0.0f;
+			}
+			OpenNode(int index, float fCost)
+			{
+				_index = index;
+				_fCost = fCost;
+			}
+			bool operator<(const OpenNode& comp)
+			{
+				return _fCost < comp._fCost;
+			}
+			bool operator>(const OpenNode& comp)
+			{
+				return _fCost > comp._fCost;
+			}
+		};
+		static const int MIN_SPLIT_ENTRANCE_LENGTH = 3;		//Entrances at least this wide get a transition at both ends instead of one in the middle
+
+		__int16 _width, _height;
+		__int16 _clusterSize;
+		__int16 _clustersX, _clustersY;
+		__int16* _tileCosts;									//cost of traversing the individual tile, indexed by tile index
+		int* _entranceSlot;										//index in the entrance list of the tile's cluster, -1 if the tile is no entrance
+		Cluster* _clusters;
+		bool _dirty;											//at least one cluster needs to be rebuilt
+
+		Node* _nodes;											//Search state, indexed by tile index
+		unsigned int _searchId;
+		Heap<OpenNode> _openQueue;
+		float* _startCosts;										//Costs from the start to every tile in its cluster
+		float* _goalCosts;										//Costs from every tile in the goal cluster to the goal
+		float* _entranceCosts;									//Costs from an entrance to every tile in its cluster, used when rebuilding
+
+		Vec2D* _path;											//Waypoints ordered from goal to start
+		int _pathLength;
+		int _pathCapacity;
+		float _pathCost;
+
+		bool IsPositionValid(Vec2D pos) const;
+		bool IsWalkable(Vec2D pos) const;
+		int GetIndex(Vec2D pos) const;
+		Vec2D GetPosition(int index) const;
+		int GetClusterIndex(Vec2D pos) const;
+		int GetLocalIndex(const Cluster& cluster, Vec2D pos) const;
+		Node& GetNode(int index);
+		void NewSearch();
+		void FindEntrances(int clusterIndex, std::vector<int>& entrances) const;
+		void FindBorderEntrances(Vec2D inside, Vec2D outside, Vec2D step, int length, std::vector<int>& entrances) const;
+		void CalculateCosts(int clusterIndex);
+		void FindCostsInCluster(int clusterIndex, Vec2D source, bool reverse, float* costs);
+		void Relax(int fromIndex, int toIndex, float cost, Vec2D goal);
+		void Rebuild();
+	public:
+		HPAStar(int width, int height, int clusterSize = 10);
+		virtual ~HPAStar();
+		void SetTileCost(Vec2D pos, int cost = 1);
+		int GetTileCost(Vec2D pos) const;
+		int GetClusterSize() const;
+		Vec2D* GetPath() const;
+		int GetPathLength() const;
+		float GetPathCost() const;
+		/*
+			Finds waypoints from start to goal. Consecutive waypoints are always within the same cluster
+			or on opposite sides of a cluster border. The goal may be unwalkable, e.g. loot placed on furniture,
+			in which case it costs 1 to enter.
+		*/
+		bool FindPath(Vec2D start, Vec2D goal);
+	};
+}
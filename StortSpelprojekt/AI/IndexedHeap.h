@@ -0,0 +1,194 @@
+#pragma once
+
+#define AI_EXPORT __declspec(dllexport)
+/*
+	Min-heap of indices, e.g. tile indices, each queued with a float key.
+	Only the indices are moved around, the keys are kept packed in an array of their own. A position table tracks
+	where every index is, so a queued index gets its key lowered instead of being queued again.
+	D is the number of children per node. A wider heap is shallower, making insert and decreaseKey cheaper
+	at the cost of more comparisons in removeMin.
+	Indices have to be below the capacity, the heap never grows.
+*/
+template <int D = 2>
+class AI_EXPORT IndexedHeap
+{
+private:
+	int* _tree;										//Queued indices in heap order
+	float* _keys;									//_keys[i] is the key of _tree[i]
+	int* _positions;								//Position in _tree of every index. Only valid if _tree points back at the index, so it never needs clearing
+	int _capacity;
+	int _nrOfElements;
+	void place(int position, int index, float key);
+	void siftUp(int position, int index, float key);
+	void siftDown(int position, int index, float key);
+
+	IndexedHeap(const IndexedHeap<D>&) = delete;
+	IndexedHeap<D>& operator=(const IndexedHeap<D>&) = delete;
+public:
+	IndexedHeap(int capacity = 0);
+	virtual ~IndexedHeap();
+	void setCapacity(int capacity);					//Also empties the heap
+	bool contains(int index) const;
+	void insert(int index, float key);
+	void decreaseKey(int index, float key);			//Does nothing if the key isn't lower
+	void insertOrDecrease(int index, float key);
+	int removeMin();
+	int getMin() const;
+	float getMinKey() const;
+	int size() const;
+	void empty();
+};
+
+template<int D>
+void IndexedHeap<D>::place(int position, int index, float key)
+{
+	_tree[position] = index;
+	_keys[position] = key;
+	_positions[index] = position;
+}
+
+/*
+	Moves the hole at position towards the root until the key fits, then fills it
+*/
+template<int D>
+void IndexedHeap<D>::siftUp(int position, int index, float key)
+{
+	while (position > 0 && key < _keys[(position - 1) / D])
+	{
+		int parent = (position - 1) / D;
+		place(position, _tree[parent], _keys[parent]);
+		position = parent;
+	}
+	place(position, index, key);
+}
+
+template<int D>
+void IndexedHeap<D>::siftDown(int position, int index, float key)
+{
+	while (D * position + 1 < _nrOfElements)
+	{
+		int first = D * position + 1;
+		int last = first + D < _nrOfElements ? first + D : _nrOfElements;
+		int smallest = first;
+		for (int child = first + 1; child < last; child++)
+		{
+			if (_keys[child] < _keys[smallest])
+			{
+				smallest = child;
+			}
+		}
+		if (!(_keys[smallest] < key))
+		{
+			break;
+		}
+		place(position, _tree[smallest], _keys[smallest]);
+		position = smallest;
+	}
+	place(position, index, key);
+}
+
+template<int D>
+IndexedHeap<D>::IndexedHeap(int capacity)
+{
+	_tree = nullptr;
+	_keys = nullptr;
+	_positions = nullptr;
+	_capacity = 0;
+	_nrOfElements = 0;
+	setCapacity(capacity);
+}
+
+template<int D>
+IndexedHeap<D>::~IndexedHeap()
+{
+	delete[] _tree;
+	delete[] _keys;
+	delete[] _positions;
+}
+
+template<int D>
+void IndexedHeap<D>::setCapacity(int capacity)
+{
+	delete[] _tree;
+	delete[] _keys;
+	delete[] _positions;
+	_capacity = capacity;
+	_nrOfElements = 0;
+	_tree = new int[capacity];
+	_keys = new float[capacity];
+	_positions = new int[capacity];
+	for (int i = 0; i < capacity; i++)
+	{
+		_positions[i] = 0;
+	}
+}
+
+template<int D>
+bool IndexedHeap<D>::contains(int index) const
+{
+	return _positions[index] < _nrOfElements && _tree[_positions[index]] == index;
+}
+
+template<int D>
+void IndexedHeap<D>::insert(int index, float key)
+{
+	siftUp(_nrOfElements++, index, key);
+}
+
+template<int D>
+void IndexedHeap<D>::decreaseKey(int index, float key)
+{
+	if (key < _keys[_positions[index]])
+	{
+		siftUp(_positions[index], index, key);
+	}
+}
+
+template<int D>
+void IndexedHeap<D>::insertOrDecrease(int index, float key)
+{
+	if (contains(index))
+	{
+		decreaseKey(index, key);
+	}
+	else
+	{
+		insert(index, key);
+	}
+}
+
+template<int D>
+int IndexedHeap<D>::removeMin()
+{
+	int result = _tree[0];
+	_nrOfElements--;
+	if (_nrOfElements > 0)
+	{
+		siftDown(0, _tree[_nrOfElements], _keys[_nrOfElements]);
+	}
+	return result;
+}
+
+template<int D>
+int IndexedHeap<D>::getMin() const
+{
+	return _tree[0];
+}
+
+template<int D>
+float IndexedHeap<D>::getMinKey() const
+{
+	return _keys[0];
+}
+
+template<int D>
+int IndexedHeap<D>::size() const
+{
+	return _nrOfElements;
+}
+
+template<int D>
+void IndexedHeap<D>::empty()
+{
+	_nrOfElements = 0;
+}
@@ -0,0 +1,492 @@
+#include "PathfindingService.h"
+
+namespace AI
+{
+	AStar* PathfindingService::AcquireWorkspace()
+	{
+		std::lock_guard<std::mutex> lock(_workspaceLock);
+		if (_freeWorkspaces.empty())
+		{
+			_workspaces.push_back(new AStar(_width, _height, _tileCosts, AStar::JUMP_POINT));
+			_freeWorkspaces.push_back(_workspaces.back());
+		}
+		AStar* workspace = _freeWorkspaces.back();
+		_freeWorkspaces.pop_back();
+		return workspace;
+	}
+
+	void PathfindingService::ReleaseWorkspace(AStar* workspace)
+	{
+		std::lock_guard<std::mutex> lock(_workspaceLock);
+		_freeWorkspaces.push_back(workspace);
+	}
+
+	bool PathfindingService::Search(__int16* tileCosts, Vec2D start, Vec2D goal, std::vector<Vec2D>& path, const std::vector<CostOverride>* overrides)
+	{
+		path.clear();
+		AStar* workspace = AcquireWorkspace();
+		workspace->ShareTileCosts(tileCosts);
+		workspace->Init(start, goal);
+		if (overrides != nullptr)
+		{
+			for (unsigned int i = 0; i < overrides->size(); i++)
+			{
+				workspace->SetTileCostOverride((*overrides)[i]._position, (*overrides)[i]._cost);
+			}
+		}
+		bool result = workspace->FindPath();
+		if (result)
+		{
+			path.assign(workspace->GetPath(), workspace->GetPath() + workspace->GetPathLength());
+		}
+		ReleaseWorkspace(workspace);
+		return result;
+	}
+
+	void PathfindingService::ClearOutdatedCache()
+	{
+		if (_cacheVersion != _costVersion)
+		{
+			_cachedPaths.clear();
+			_cacheIndex.clear();
+			_cacheVersion = _costVersion;
+		}
+	}
+
+	/*
+		Every part of a cheapest path is a cheapest path of its own, so a cached path passing start and then goal is used.
+		While every walkable tile costs the same, a path is as cheap in both directions and may be walked backwards too.
+	*/
+	bool PathfindingService::FindCachedPath(Vec2D start, Vec2D goal, bool& found, std::vector<Vec2D>& path)
+	{
+		ClearOutdatedCache();
+		std::map<std::pair<int, int>, std::list<CachedPath>::iterator>::iterator exact =
+			_cacheIndex.find(std::make_pair(start._y * _width + start._x, goal._y * _width + goal._x));
+		if (exact != _cacheIndex.end())
+		{
+			_cachedPaths.splice(_cachedPaths.begin(), _cachedPaths, exact->second);
+			found = exact->second->_found;
+			path = exact->second->_path;
+			_nrOfCacheHits++;
+			return true;
+		}
+		for (std::list<CachedPath>::iterator i = _cachedPaths.begin(); i != _cachedPaths.end() && start != goal; i++)
+		{
+			if (!i->_found)
+			{
+				continue;
+			}
+			int nrOfTiles = (int)i->_path.size();								//The start of the cached path follows as tile nrOfTiles
+			int startTile = -1;
+			int goalTile = -1;
+			for (int k = 0; k <= nrOfTiles && (startTile == -1 || goalTile == -1); k++)
+			{
+				Vec2D pos = k < nrOfTiles ? i->_path[k] : i->_start;
+				if (pos == start)
+				{
+					startTile = k;
+				}
+				else if (pos == goal)
+				{
+					goalTile = k;
+				}
+			}
+			if (startTile == -1 || goalTile == -1)
+			{
+				continue;
+			}
+			if (goalTile < startTile)
+			{
+				path.assign(i->_path.begin() + goalTile, i->_path.begin() + startTile);
+			}
+			else if (_nrOfWeightedTiles == 0)
+			{
+				path.clear();
+				for (int k = goalTile; k > startTile; k--)
+				{
+					path.push_back(k < nrOfTiles ? i->_path[k] : i->_start);
+				}
+			}
+			else
+			{
+				continue;
+			}
+			_cachedPaths.splice(_cachedPaths.begin(), _cachedPaths, i);
+			found = true;
+			_nrOfCacheHits++;
+			return true;
+		}
+		_nrOfCacheMisses++;
+		return false;
+	}
+
+	/*
+		Replaces the least recently used path once the cache is full
+	*/
+	void PathfindingService::CachePath(Vec2D start, Vec2D goal, bool found, const std::vector<Vec2D>& path)
+	{
+		ClearOutdatedCache();
+		std::pair<int, int> key = std::make_pair(start._y * _width + start._x, goal._y * _width + goal._x);
+		std::map<std::pair<int, int>, std::list<CachedPath>::iterator>::iterator cached = _cacheIndex.find(key);
+		if (cached != _cacheIndex.end())
+		{
+			_cachedPaths.splice(_cachedPaths.begin(), _cachedPaths, cached->second);
+		}
+		else
+		{
+			_cachedPaths.push_front(CachedPath());
+			_cacheIndex[key] = _cachedPaths.begin();
+			if ((int)_cachedPaths.size() > PATH_CACHE_SIZE)
+			{
+				CachedPath& oldest = _cachedPaths.back();
+				_cacheIndex.erase(std::make_pair(oldest._start._y * _width + oldest._start._x, oldest._goal._y * _width + oldest._goal._x));
+				_cachedPaths.pop_back();
+			}
+		}
+		CachedPath& entry = _cachedPaths.front();
+		entry._start = start;
+		entry._goal = goal;
+		entry._found = found;
+		entry._path = path;
+	}
+
+	/*
+		Takes requests off the queue until the service is destroyed
+	*/
+	void PathfindingService::RunWorker()
+	{
+		std::unique_lock<std::mutex> lock(_requestLock);
+		while (true)
+		{
+			_requestAdded.wait(lock, [this]() { return _stopping || !_requests.empty(); });
+			if (_stopping)
+			{
+				return;
+			}
+			PathRequest request = _requests.front();
+			_requests.pop_front();
+			_searching.insert(request._id);
+			lock.unlock();
+
+			PathResult result;
+			result._found = Search(request._tileCosts->data(), request._start, request._goal, result._path, &request._overrides);
+
+			lock.lock();
+			_searching.erase(request._id);
+			if (_cancelled.erase(request._id) == 0)
+			{
+				PathResult& stored = _results[request._id];
+				stored._found = result._found;
+				stored._path.swap(result._path);
+				stored._start = request._start;
+				stored._goal = request._goal;
+				stored._costVersion = request._costVersion;
+				stored._cacheable = request._overrides.empty();
+			}
+		}
+	}
+
+	/*
+		Every tile starts out walkable with a cost of 1
+	*/
+	PathfindingService::PathfindingService(int width, int height, int nrOfWorkspaces)
+	{
+		_width = width;
+		_height = height;
+		_tileCosts = new __int16[width * height];
+		for (int i = 0; i < width * height; i++)
+		{
+			_tileCosts[i] = 1;
+		}
+		_hierarchical = new HPAStar(width, height);
+		_costVersion = 0;
+		_nextRequestId = 0;
+		_stopping = false;
+		_snapshotVersion = 0;
+		_nrOfWeightedTiles = 0;
+		_cacheVersion = 0;
+		_nrOfCacheHits = 0;
+		_nrOfCacheMisses = 0;
+		for (int i = 0; i < nrOfWorkspaces; i++)
+		{
+			_workspaces.push_back(new AStar(width, height, _tileCosts, AStar::JUMP_POINT));
+			_freeWorkspaces.push_back(_workspaces.back());
+		}
+	}
+
+	PathfindingService::~PathfindingService()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_requestLock);
+			_stopping = true;
+		}
+		_requestAdded.notify_all();
+		for (unsigned int i = 0; i < _workers.size(); i++)
+		{
+			_workers[i].join();
+		}
+		for (unsigned int i = 0; i < _workspaces.size(); i++)
+		{
+			delete _workspaces[i];
+		}
+		for (unsigned int i = 0; i < _freePlanners.size(); i++)
+		{
+			delete _freePlanners[i];
+		}
+		for (std::map<int, std::vector<SharedFlowField>>::iterator i = _flowFields.begin(); i != _flowFields.end(); i++)
+		{
+			for (unsigned int j = 0; j < i->second.size(); j++)
+			{
+				delete i->second[j]._flowField;
+			}
+		}
+		delete _hierarchical;
+		delete[] _tileCosts;
+	}
+
+	void PathfindingService::SetTileCost(Vec2D pos, int cost)
+	{
+		if (_tileCosts[pos._y * _width + pos._x] != cost)
+		{
+			_nrOfWeightedTiles += (cost > 1) - (_tileCosts[pos._y * _width + pos._x] > 1);
+			_tileCosts[pos._y * _width + pos._x] = cost;
+			_hierarchical->SetTileCost(pos, cost);
+			_costVersion++;
+			_changedTiles.push_back(pos);
+			if ((int)_changedTiles.size() > MAX_NR_OF_LOGGED_CHANGES)
+			{
+				_changedTiles.pop_front();
+			}
+		}
+	}
+
+	int PathfindingService::GetTileCost(Vec2D pos) const
+	{
+		return _tileCosts[pos._y * _width + pos._x];
+	}
+
+	int PathfindingService::GetWidth() const
+	{
+		return _width;
+	}
+
+	int PathfindingService::GetHeight() const
+	{
+		return _height;
+	}
+
+	int PathfindingService::GetClusterSize() const
+	{
+		return _hierarchical->GetClusterSize();
+	}
+
+	int PathfindingService::GetNrOfWorkspaces() const
+	{
+		return (int)_workspaces.size();
+	}
+
+	unsigned int PathfindingService::GetCostVersion() const
+	{
+		return _costVersion;
+	}
+
+	int PathfindingService::GetNrOfCacheHits() const
+	{
+		return _nrOfCacheHits;
+	}
+
+	int PathfindingService::GetNrOfCacheMisses() const
+	{
+		return _nrOfCacheMisses;
+	}
+
+	void PathfindingService::ResetCacheCounters()
+	{
+		_nrOfCacheHits = 0;
+		_nrOfCacheMisses = 0;
+	}
+
+	bool PathfindingService::FindPath(Vec2D start, Vec2D goal, std::vector<Vec2D>& path, const std::vector<CostOverride>* overrides)
+	{
+		bool cacheable = overrides == nullptr || overrides->empty();
+		bool found = false;
+		if (cacheable && FindCachedPath(start, goal, found, path))
+		{
+			return found;
+		}
+		found = Search(_tileCosts, start, goal, path, overrides);
+		if (cacheable)
+		{
+			CachePath(start, goal, found, path);
+		}
+		return found;
+	}
+
+	bool PathfindingService::FindWaypoints(Vec2D start, Vec2D goal, std::vector<Vec2D>& waypoints)
+	{
+		waypoints.clear();
+		bool result = _hierarchical->FindPath(start, goal);
+		if (result)
+		{
+			waypoints.assign(_hierarchical->GetPath(), _hierarchical->GetPath() + _hierarchical->GetPathLength());
+		}
+		return result;
+	}
+
+	void PathfindingService::BuildFlowField(FlowField* flowField, const std::vector<CostOverride>& overrides)
+	{
+		if (overrides.empty())
+		{
+			flowField->Build(_tileCosts, _costVersion);
+			return;
+		}
+		_overriddenTileCosts.assign(_tileCosts, _tileCosts + _width * _height);
+		for (unsigned int i = 0; i < overrides.size(); i++)
+		{
+			_overriddenTileCosts[overrides[i]._position._y * _width + overrides[i]._position._x] = overrides[i]._cost;
+		}
+		flowField->Build(_overriddenTileCosts.data(), _costVersion);
+	}
+
+	FlowField* PathfindingService::GetFlowField(Vec2D goal, const std::vector<CostOverride>* overrides)
+	{
+		static const std::vector<CostOverride> NO_OVERRIDES;
+		const std::vector<CostOverride>& wantedOverrides = overrides != nullptr ? *overrides : NO_OVERRIDES;
+		std::vector<SharedFlowField>& flowFields = _flowFields[goal._y * _width + goal._x];
+		for (unsigned int i = 0; i < flowFields.size(); i++)
+		{
+			if (flowFields[i]._overrides == wantedOverrides)
+			{
+				if (flowFields[i]._flowField->GetCostVersion() != _costVersion)
+				{
+					BuildFlowField(flowFields[i]._flowField, wantedOverrides);
+				}
+				return flowFields[i]._flowField;
+			}
+		}
+		SharedFlowField flowField;
+		flowField._overrides = wantedOverrides;
+		flowField._flowField = new FlowField(_width, _height, goal);
+		BuildFlowField(flowField._flowField, wantedOverrides);
+		flowFields.push_back(flowField);
+		return flowField._flowField;
+	}
+
+	DStarLite* PathfindingService::CreatePlanner()
+	{
+		if (_freePlanners.empty())
+		{
+			return new DStarLite(_width, _height, _tileCosts);
+		}
+		DStarLite* planner = _freePlanners.back();
+		_freePlanners.pop_back();
+		planner->SetTileCosts(_tileCosts);
+		return planner;
+	}
+
+	void PathfindingService::ReleasePlanner(DStarLite* planner)
+	{
+		_freePlanners.push_back(planner);
+	}
+
+	bool PathfindingService::GetChangedTiles(unsigned int sinceVersion, std::vector<Vec2D>& changedTiles) const
+	{
+		unsigned int nrOfChanges = _costVersion - sinceVersion;
+		if (nrOfChanges > _changedTiles.size())
+		{
+			return false;
+		}
+		changedTiles.insert(changedTiles.end(), _changedTiles.end() - nrOfChanges, _changedTiles.end());
+		return true;
+	}
+
+	int PathfindingService::RequestPath(Vec2D start, Vec2D goal, const std::vector<CostOverride>* overrides)
+	{
+		PathResult cached;
+		if ((overrides == nullptr || overrides->empty()) && FindCachedPath(start, goal, cached._found, cached._path))
+		{
+			cached._cacheable = false;											//Already is
+			std::lock_guard<std::mutex> lock(_requestLock);
+			int requestId = _nextRequestId++;
+			_results[requestId] = cached;
+			return requestId;
+		}
+		if (_workers.empty())
+		{
+			int nrOfWorkers = (int)std::thread::hardware_concurrency() - 1;		//Leaves a core for the main thread
+			if (nrOfWorkers < 1)
+			{
+				nrOfWorkers = 1;
+			}
+			else if (nrOfWorkers > MAX_NR_OF_WORKERS)
+			{
+				nrOfWorkers = MAX_NR_OF_WORKERS;
+			}
+			for (int i = 0; i < nrOfWorkers; i++)
+			{
+				_workers.push_back(std::thread(&PathfindingService::RunWorker, this));
+			}
+		}
+		if (_snapshot == nullptr || _snapshotVersion != _costVersion)
+		{
+			_snapshot = std::make_shared<std::vector<__int16>>(_tileCosts, _tileCosts + _width * _height);
+			_snapshotVersion = _costVersion;
+		}
+
+		PathRequest request;
+		request._start = start;
+		request._goal = goal;
+		request._tileCosts = _snapshot;
+		request._costVersion = _snapshotVersion;
+		if (overrides != nullptr)
+		{
+			request._overrides = *overrides;
+		}
+		{
+			std::lock_guard<std::mutex> lock(_requestLock);
+			request._id = _nextRequestId++;
+			_requests.push_back(request);
+		}
+		_requestAdded.notify_one();
+		return request._id;
+	}
+
+	bool PathfindingService::GetPathResult(int requestId, bool& found, std::vector<Vec2D>& path)
+	{
+		std::lock_guard<std::mutex> lock(_requestLock);
+		std::map<int, PathResult>::iterator result = _results.find(requestId);
+		if (result == _results.end())
+		{
+			return false;
+		}
+		found = result->second._found;
+		path.swap(result->second._path);
+		if (result->second._cacheable && result->second._costVersion == _costVersion)
+		{
+			CachePath(result->second._start, result->second._goal, found, path);
+		}
+		_results.erase(result);
+		return true;
+	}
+
+	void PathfindingService::CancelPathRequest(int requestId)
+	{
+		std::lock_guard<std::mutex> lock(_requestLock);
+		if (_results.erase(requestId) > 0)
+		{
+			return;
+		}
+		for (std::deque<PathRequest>::iterator i = _requests.begin(); i != _requests.end(); i++)
+		{
+			if (i->_id == requestId)
+			{
+				_requests.erase(i);
+				return;
+			}
+		}
+		if (_searching.count(requestId) > 0)
+		{
+			_cancelled.insert(requestId);
+		}
+	}
+}
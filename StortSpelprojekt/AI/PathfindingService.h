@@ -0,0 +1,192 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <list>
+#include <set>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "AStar.h"
+#include "HPAStar.h"
+#include "FlowField.h"
+#include "DStarLite.h"
+#include "AIUtil.h"
+
+#define AI_EXPORT __declspec(dllexport)
+
+namespace AI
+{
+	/*
+		A tile cost that only applies to the search of a single unit, e.g. an enemy avoiding known traps
+	*/
+	struct AI_EXPORT CostOverride
+	{
+		Vec2D _position;
+		int _cost;
+		CostOverride()
+		{
+			_cost = 1;
+		}
+		CostOverride(Vec2D position, int cost)
+		{
+			_position = position;
+			_cost = cost;
+		}
+		bool operator==(const CostOverride& other) const
+		{
+			return _position == other._position && _cost == other._cost;
+		}
+	};
+
+	/*
+		Pathfinding shared by every unit on a map.
+		Holds the only copy of the tile costs. Searches run on a small pool of AStar workspaces reading those costs,
+		so memory no longer grows with the number of units. Long trips can be planned with HPAStar first,
+		and popular goals get a FlowField that any number of units can follow.
+		Paths can also be requested asynchronously. Those searches run on worker threads against a snapshot
+		of the tile costs taken when the request was made, and the result is picked up on a later frame.
+	*/
+	class AI_EXPORT PathfindingService
+	{
+	private:
+		__int16 _width, _height;
+		__int16* _tileCosts;
+		HPAStar* _hierarchical;
+		std::vector<AStar*> _workspaces;						//Every workspace ever created, owned by the service
+		std::vector<AStar*> _freeWorkspaces;					//Workspaces not currently used by a search
+		std::vector<DStarLite*> _freePlanners;					//Planners given back by units, handed out again before new ones are created
+		unsigned int _costVersion;								//Incremented whenever a tile cost changes
+		/*
+			A flow field and the unit specific costs it was built with
+		*/
+		struct SharedFlowField
+		{
+			std::vector<CostOverride> _overrides;
+			FlowField* _flowField;
+		};
+		std::map<int, std::vector<SharedFlowField>> _flowFields;	//Keyed by the tile index of the goal
+		std::vector<__int16> _overriddenTileCosts;				//The tile costs with the overrides of the flow field being built
+		std::deque<Vec2D> _changedTiles;						//The latest tiles to change cost, one per cost version with the newest at the back
+		int _nrOfWeightedTiles;									//Tiles costing more than 1. Without any, every path is as cheap walked backwards
+
+		/*
+			A path found earlier, ordered like FindPath. Paths that weren't found are cached too, with an empty path
+		*/
+		struct CachedPath
+		{
+			Vec2D _start, _goal;
+			bool _found;
+			std::vector<Vec2D> _path;
+		};
+		std::list<CachedPath> _cachedPaths;										//Most recently used first
+		std::map<std::pair<int, int>, std::list<CachedPath>::iterator> _cacheIndex;	//Keyed by the tile indices of start and goal
+		unsigned int _cacheVersion;												//Cost version the cached paths were found with
+		int _nrOfCacheHits, _nrOfCacheMisses;
+		std::mutex _workspaceLock;								//Workspaces are shared between the main thread and the workers
+
+		/*
+			An asynchronous search waiting for a worker
+		*/
+		struct PathRequest
+		{
+			int _id;
+			Vec2D _start, _goal;
+			std::vector<CostOverride> _overrides;
+			std::shared_ptr<std::vector<__int16>> _tileCosts;	//Snapshot of the costs when the request was made
+			unsigned int _costVersion;							//Version of the snapshot
+		};
+		struct PathResult
+		{
+			bool _found;
+			std::vector<Vec2D> _path;
+			Vec2D _start, _goal;
+			unsigned int _costVersion;							//The result is only cached if no costs have changed since
+			bool _cacheable;									//False if unit specific costs were used
+		};
+		std::vector<std::thread> _workers;						//Started with the first request
+		std::mutex _requestLock;								//Guards everything below
+		std::condition_variable _requestAdded;
+		std::deque<PathRequest> _requests;
+		std::map<int, PathResult> _results;
+		std::set<int> _searching;								//Requests a worker is currently searching for
+		std::set<int> _cancelled;								//Requests cancelled while being searched for
+		int _nextRequestId;
+		bool _stopping;
+		std::shared_ptr<std::vector<__int16>> _snapshot;		//Latest snapshot of the tile costs, shared by requests until the costs change
+		unsigned int _snapshotVersion;
+
+		AStar* AcquireWorkspace();
+		void ReleaseWorkspace(AStar* workspace);
+		bool Search(__int16* tileCosts, Vec2D start, Vec2D goal, std::vector<Vec2D>& path, const std::vector<CostOverride>* overrides);
+		void BuildFlowField(FlowField* flowField, const std::vector<CostOverride>& overrides);
+		void ClearOutdatedCache();
+		bool FindCachedPath(Vec2D start, Vec2D goal, bool& found, std::vector<Vec2D>& path);
+		void CachePath(Vec2D start, Vec2D goal, bool found, const std::vector<Vec2D>& path);
+		void RunWorker();
+
+		PathfindingService(const PathfindingService&) = delete;
+		PathfindingService& operator=(const PathfindingService&) = delete;
+	public:
+		static const int MAX_NR_OF_WORKERS = 4;
+		static const int MAX_NR_OF_LOGGED_CHANGES = 256;
+		static const int PATH_CACHE_SIZE = 64;
+		PathfindingService(int width, int height, int nrOfWorkspaces = 1);
+		virtual ~PathfindingService();
+
+		void SetTileCost(Vec2D pos, int cost = 1);
+		int GetTileCost(Vec2D pos) const;
+		int GetWidth() const;
+		int GetHeight() const;
+		int GetClusterSize() const;
+		int GetNrOfWorkspaces() const;
+		unsigned int GetCostVersion() const;
+		int GetNrOfCacheHits() const;
+		int GetNrOfCacheMisses() const;
+		void ResetCacheCounters();
+
+		/*
+			Finds a path with A* from start to goal, written to path ordered from goal to start without the start tile.
+			The overrides replace the shared tile costs for this search only.
+			Without overrides, the path is first looked for among the latest paths found. A cached path that passes
+			start and then goal gives its part between them, as does one passing them in the opposite order while
+			no tile costs more than 1. The cache is emptied when a tile cost changes.
+		*/
+		bool FindPath(Vec2D start, Vec2D goal, std::vector<Vec2D>& path, const std::vector<CostOverride>* overrides = nullptr);
+		/*
+			Finds waypoints for a long trip with HPAStar, ordered like FindPath. Unit specific costs are not considered,
+			they are added when the path between the waypoints is found with FindPath.
+		*/
+		bool FindWaypoints(Vec2D start, Vec2D goal, std::vector<Vec2D>& waypoints);
+		/*
+			Returns the flow field towards the goal, built the first time it is asked for and rebuilt
+			if the tile costs have changed since. The overrides replace the shared tile costs in the field,
+			which is shared by every unit asking with the same overrides.
+		*/
+		FlowField* GetFlowField(Vec2D goal, const std::vector<CostOverride>* overrides = nullptr);
+		/*
+			Returns an incremental planner with a copy of the current tile costs. A released planner is reused if there is one,
+			so units coming and going do not allocate new ones. The caller owns it until it is given back with ReleasePlanner
+		*/
+		DStarLite* CreatePlanner();
+		void ReleasePlanner(DStarLite* planner);				//Owned by the service again, and deleted with it
+		/*
+			Adds the tiles that have changed cost since the given cost version, so a planner can be kept up to date.
+			Returns false if too many have changed to remember them all, in which case the planner is better off rebuilt.
+		*/
+		bool GetChangedTiles(unsigned int sinceVersion, std::vector<Vec2D>& changedTiles) const;
+
+		/*
+			Queues a search like FindPath to be run on a worker thread. Returns the id used to pick up the result.
+			A path found in the cache is ready right away.
+		*/
+		int RequestPath(Vec2D start, Vec2D goal, const std::vector<CostOverride>* overrides = nullptr);
+		/*
+			Returns false while the request is still being worked on. Once it returns true the result has been
+			written to found and path, and the id is no longer valid.
+		*/
+		bool GetPathResult(int requestId, bool& found, std::vector<Vec2D>& path);
+		void CancelPathRequest(int requestId);						//The result of the request is thrown away
+	};
+}
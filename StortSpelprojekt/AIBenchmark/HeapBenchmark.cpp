@@ -0,0 +1,195 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "Portability.h"
+#include "Heap.h"
+#include "IndexedHeap.h"
+
+/*
+	Compares Heap, queueing a tile again every time it gets cheaper, to IndexedHeap of a few widths lowering
+	the key instead. Every queue runs the same Dijkstra searches over a random weighted grid, which is the access
+	pattern of AStar and FlowField. The sum of the costs found is printed to show that the searches agree.
+*/
+
+const int WIDTH = 256;
+const int HEIGHT = 256;
+const int NR_OF_SEARCHES = 40;
+const int OFFSETS[8][2] = { { -1, 0 },{ 1, 0 },{ 0, -1 },{ 0, 1 },{ -1, -1 },{ 1, -1 },{ -1, 1 },{ 1, 1 } };
+
+struct OpenNode
+{
+	int _index;
+	float _cost;
+	OpenNode()
+	{
+		_index = -1;
+		_cost = 0.0f;
+	}
+	OpenNode(int index, float cost)
+	{
+		_index = index;
+		_cost = cost;
+	}
+	bool operator<(const OpenNode& comp)
+	{
+		return _cost < comp._cost;
+	}
+	bool operator>(const OpenNode& comp)
+	{
+		return _cost > comp._cost;
+	}
+};
+
+struct Result
+{
+	double _milliseconds;
+	double _costSum;
+	long long _nrOfInserts;
+	long long _nrOfRemoves;
+	Result()
+	{
+		_milliseconds = 0.0;
+		_costSum = 0.0;
+		_nrOfInserts = 0;
+		_nrOfRemoves = 0;
+	}
+};
+
+float GetStepCost(const std::vector<short>& tileCosts, int x, int y, int i)
+{
+	int nx = x + OFFSETS[i][0];
+	int ny = y + OFFSETS[i][1];
+	if (nx < 0 || nx >= WIDTH || ny < 0 || ny >= HEIGHT || tileCosts[ny * WIDTH + nx] <= 0 ||
+		tileCosts[y * WIDTH + nx] <= 0 || tileCosts[ny * WIDTH + x] <= 0)		//checks for walls and corners
+	{
+		return -1.0f;
+	}
+	return i < 4 ? tileCosts[ny * WIDTH + nx] : 1.41421356f * tileCosts[ny * WIDTH + nx];
+}
+
+Result RunHeap(const std::vector<short>& tileCosts, const std::vector<int>& sources)
+{
+	Result result;
+	Heap<OpenNode> openQueue;
+	std::vector<float> costs(WIDTH * HEIGHT);
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (unsigned int s = 0; s < sources.size(); s++)
+	{
+		for (int i = 0; i < WIDTH * HEIGHT; i++)
+		{
+			costs[i] = -1.0f;
+		}
+		openQueue.empty();
+		costs[sources[s]] = 0.0f;
+		openQueue.insert(OpenNode(sources[s], 0.0f));
+		result._nrOfInserts++;
+		while (openQueue.size() > 0)
+		{
+			OpenNode current = openQueue.removeMin();
+			result._nrOfRemoves++;
+			if (current._cost > costs[current._index])								//Stale duplicate
+			{
+				continue;
+			}
+			int x = current._index % WIDTH;
+			int y = current._index / WIDTH;
+			for (int i = 0; i < 8; i++)
+			{
+				float stepCost = GetStepCost(tileCosts, x, y, i);
+				int next = (y + OFFSETS[i][1]) * WIDTH + x + OFFSETS[i][0];
+				if (stepCost >= 0.0f && (costs[next] < 0.0f || costs[next] > current._cost + stepCost))
+				{
+					costs[next] = current._cost + stepCost;
+					openQueue.insert(OpenNode(next, costs[next]));
+					result._nrOfInserts++;
+				}
+			}
+		}
+		for (int i = 0; i < WIDTH * HEIGHT; i++)
+		{
+			result._costSum += costs[i] > 0.0f ? costs[i] : 0.0f;
+		}
+	}
+	result._milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return result;
+}
+
+template <int D>
+Result RunIndexedHeap(const std::vector<short>& tileCosts, const std::vector<int>& sources)
+{
+	Result result;
+	IndexedHeap<D> openQueue(WIDTH * HEIGHT);
+	std::vector<float> costs(WIDTH * HEIGHT);
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (unsigned int s = 0; s < sources.size(); s++)
+	{
+		for (int i = 0; i < WIDTH * HEIGHT; i++)
+		{
+			costs[i] = -1.0f;
+		}
+		openQueue.empty();
+		costs[sources[s]] = 0.0f;
+		openQueue.insert(sources[s], 0.0f);
+		result._nrOfInserts++;
+		while (openQueue.size() > 0)
+		{
+			int current = openQueue.removeMin();
+			result._nrOfRemoves++;
+			int x = current % WIDTH;
+			int y = current / WIDTH;
+			for (int i = 0; i < 8; i++)
+			{
+				float stepCost = GetStepCost(tileCosts, x, y, i);
+				int next = (y + OFFSETS[i][1]) * WIDTH + x + OFFSETS[i][0];
+				if (stepCost >= 0.0f && (costs[next] < 0.0f || costs[next] > costs[current] + stepCost))
+				{
+					costs[next] = costs[current] + stepCost;
+					if (!openQueue.contains(next))
+					{
+						result._nrOfInserts++;
+					}
+					openQueue.insertOrDecrease(next, costs[next]);
+				}
+			}
+		}
+		for (int i = 0; i < WIDTH * HEIGHT; i++)
+		{
+			result._costSum += costs[i] > 0.0f ? costs[i] : 0.0f;
+		}
+	}
+	result._milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return result;
+}
+
+void PrintResult(const char* name, const Result& result)
+{
+	printf("%-16s %10.2f ms %12lld inserts %12lld removes   cost sum %.1f\n", name, result._milliseconds / NR_OF_SEARCHES,
+		result._nrOfInserts / NR_OF_SEARCHES, result._nrOfRemoves / NR_OF_SEARCHES, result._costSum);
+}
+
+int main(int argc, char** argv)
+{
+	srand(argc > 1 ? atoi(argv[1]) : 1);
+	std::vector<short> tileCosts(WIDTH * HEIGHT);
+	for (int i = 0; i < WIDTH * HEIGHT; i++)
+	{
+		tileCosts[i] = rand() % 100 < 20 ? -1 : (short)(1 + rand() % 9);
+	}
+	std::vector<int> sources;
+	while ((int)sources.size() < NR_OF_SEARCHES)
+	{
+		int source = rand() % (WIDTH * HEIGHT);
+		if (tileCosts[source] > 0)
+		{
+			sources.push_back(source);
+		}
+	}
+
+	printf("Dijkstra on a %dx%d grid, average of %d searches\n", WIDTH, HEIGHT, NR_OF_SEARCHES);
+	PrintResult("Heap", RunHeap(tileCosts, sources));
+	PrintResult("IndexedHeap<2>", RunIndexedHeap<2>(tileCosts, sources));
+	PrintResult("IndexedHeap<4>", RunIndexedHeap<4>(tileCosts, sources));
+	PrintResult("IndexedHeap<8>", RunIndexedHeap<8>(tileCosts, sources));
+	return 0;
+}
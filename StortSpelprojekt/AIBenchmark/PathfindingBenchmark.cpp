@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include "Portability.h"
+#include "AStar.h"
+
+/*
+	Runs the same batch of start/goal queries with every AStar heuristic on a few kinds of generated maps,
+	and reports expanded nodes, latency percentiles and heap allocations per query.
+	Usage: PathfindingBenchmark [width] [height] [queries] [seed]
+*/
+
+std::atomic<long long> nrOfAllocations(0);
+
+void* operator new(std::size_t size)
+{
+	nrOfAllocations++;
+	void* memory = malloc(size > 0 ? size : 1);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	free(memory);
+}
+
+struct Map
+{
+	std::string _name;
+	int _width, _height;
+	std::vector<short> _tileCosts;			//Indexed by y * width + x, -1 for walls
+	Map(const std::string& name, int width, int height, short cost)
+	{
+		_name = name;
+		_width = width;
+		_height = height;
+		_tileCosts.assign(width * height, cost);
+	}
+	short& At(int x, int y)
+	{
+		return _tileCosts[y * _width + x];
+	}
+};
+
+struct Query
+{
+	AI::Vec2D _start, _goal;
+};
+
+struct Measurement
+{
+	int _nrOfFound;
+	long long _nrOfExpandedNodes;
+	long long _nrOfAllocations;
+	std::vector<double> _microseconds;
+	Measurement()
+	{
+		_nrOfFound = 0;
+		_nrOfExpandedNodes = 0;
+		_nrOfAllocations = 0;
+	}
+};
+
+/*
+	Walls scattered over an open map, a quarter of the tiles
+*/
+Map GenerateRandom(int width, int height)
+{
+	Map map("random", width, height, 1);
+	for (int i = 0; i < width * height; i++)
+	{
+		if (rand() % 100 < 25)
+		{
+			map._tileCosts[i] = -1;
+		}
+	}
+	return map;
+}
+
+/*
+	Perfect maze with one tile wide passages, carved with a depth first search over the odd tiles
+*/
+Map GenerateMaze(int width, int height)
+{
+	Map map("maze", width, height, -1);
+	const int STEPS[4][2] = { { 2, 0 },{ -2, 0 },{ 0, 2 },{ 0, -2 } };
+	std::vector<int> stack;
+	map.At(1, 1) = 1;
+	stack.push_back(width + 1);
+	while (!stack.empty())
+	{
+		int x = stack.back() % width;
+		int y = stack.back() / width;
+		int directions[4] = { 0, 1, 2, 3 };
+		for (int i = 3; i > 0; i--)
+		{
+			std::swap(directions[i], directions[rand() % (i + 1)]);
+		}
+		bool carved = false;
+		for (int i = 0; i < 4 && !carved; i++)
+		{
+			int nx = x + STEPS[directions[i]][0];
+			int ny = y + STEPS[directions[i]][1];
+			if (nx > 0 && nx < width - 1 && ny > 0 && ny < height - 1 && map.At(nx, ny) == -1)
+			{
+				map.At((x + nx) / 2, (y + ny) / 2) = 1;
+				map.At(nx, ny) = 1;
+				stack.push_back(ny * width + nx);
+				carved = true;
+			}
+		}
+		if (!carved)
+		{
+			stack.pop_back();
+		}
+	}
+	return map;
+}
+
+/*
+	A grid of open rooms separated by walls, with a two tile wide door to each neighbouring room
+*/
+Map GenerateRooms(int width, int height)
+{
+	const int ROOM_SIZE = 12;
+	Map map("rooms", width, height, 1);
+	for (int y = 0; y < height; y += ROOM_SIZE)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			map.At(x, y) = -1;
+		}
+	}
+	for (int x = 0; x < width; x += ROOM_SIZE)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			map.At(x, y) = -1;
+		}
+	}
+	for (int y = 0; y < height; y += ROOM_SIZE)
+	{
+		for (int x = 0; x < width; x += ROOM_SIZE)
+		{
+			int door = 1 + rand() % (ROOM_SIZE - 3);
+			if (y > 0 && x + door + 1 < width)
+			{
+				map.At(x + door, y) = 1;
+				map.At(x + door + 1, y) = 1;
+			}
+			door = 1 + rand() % (ROOM_SIZE - 3);
+			if (x > 0 && y + door + 1 < height)
+			{
+				map.At(x, y + door) = 1;
+				map.At(x, y + door + 1) = 1;
+			}
+		}
+	}
+	return map;
+}
+
+/*
+	Long horizontal corridors joined by a single short passage each, so most trips wind back and forth across the map
+*/
+Map GenerateCorridors(int width, int height)
+{
+	const int SPACING = 4;
+	Map map("corridors", width, height, -1);
+	for (int y = 1; y + 1 < height; y += SPACING)
+	{
+		for (int x = 1; x < width - 1; x++)
+		{
+			map.At(x, y) = 1;
+			map.At(x, y + 1) = 1;
+		}
+		if (y + SPACING + 1 < height)
+		{
+			int passage = 1 + rand() % (width - 2);
+			for (int i = y + 2; i <= y + SPACING; i++)
+			{
+				map.At(passage, i) = 1;
+			}
+		}
+	}
+	return map;
+}
+
+std::vector<Query> GenerateQueries(Map& map, int nrOfQueries)
+{
+	std::vector<AI::Vec2D> walkable;
+	for (int y = 0; y < map._height; y++)
+	{
+		for (int x = 0; x < map._width; x++)
+		{
+			if (map.At(x, y) > 0)
+			{
+				walkable.push_back(AI::Vec2D(x, y));
+			}
+		}
+	}
+	std::vector<Query> queries;
+	while ((int)queries.size() < nrOfQueries && walkable.size() > 1)
+	{
+		Query query;
+		query._start = walkable[rand() % walkable.size()];
+		query._goal = walkable[rand() % walkable.size()];
+		if (query._start != query._goal)
+		{
+			queries.push_back(query);
+		}
+	}
+	return queries;
+}
+
+Measurement Run(Map& map, const std::vector<Query>& queries, AI::AStar::Heuristic heuristic)
+{
+	Measurement measurement;
+	measurement._microseconds.reserve(queries.size());
+	AI::AStar aStar(map._width, map._height, heuristic);
+	for (int y = 0; y < map._height; y++)
+	{
+		for (int x = 0; x < map._width; x++)
+		{
+			aStar.SetTileCost(AI::Vec2D(x, y), map.At(x, y));
+		}
+	}
+	for (unsigned int i = 0; i < queries.size(); i++)
+	{
+		long long allocationsBefore = nrOfAllocations;
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		aStar.Init(queries[i]._start, queries[i]._goal);
+		bool found = aStar.FindPath();
+		std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+		measurement._nrOfAllocations += nrOfAllocations - allocationsBefore;
+		measurement._microseconds.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+		measurement._nrOfExpandedNodes += aStar.GetNrOfExpandedNodes();
+		measurement._nrOfFound += found;
+	}
+	return measurement;
+}
+
+double GetPercentile(const std::vector<double>& sorted, double percentile)
+{
+	int index = (int)(percentile / 100.0 * (sorted.size() - 1) + 0.5);
+	return sorted[index];
+}
+
+int main(int argc, char** argv)
+{
+	int width = argc > 1 ? atoi(argv[1]) : 128;
+	int height = argc > 2 ? atoi(argv[2]) : 128;
+	int nrOfQueries = argc > 3 ? atoi(argv[3]) : 500;
+	srand(argc > 4 ? atoi(argv[4]) : 1);
+	if (width < 16 || height < 16 || nrOfQueries < 1)
+	{
+		printf("Usage: PathfindingBenchmark [width >= 16] [height >= 16] [queries >= 1] [seed]\n");
+		return 1;
+	}
+
+	const char* HEURISTIC_NAMES[] = { "MANHATTAN", "CHEBYSHEV", "OCTILE", "EUCLIDEAN", "JUMP_POINT" };
+	const AI::AStar::Heuristic HEURISTICS[] = { AI::AStar::MANHATTAN, AI::AStar::CHEBYSHEV, AI::AStar::OCTILE, AI::AStar::EUCLIDEAN, AI::AStar::JUMP_POINT };
+	std::vector<Map> maps;
+	maps.push_back(GenerateMaze(width, height));
+	maps.push_back(GenerateRooms(width, height));
+	maps.push_back(GenerateCorridors(width, height));
+	maps.push_back(GenerateRandom(width, height));
+
+	printf("%dx%d maps, %d queries each\n", width, height, nrOfQueries);
+	printf("%-10s %-11s %7s %10s %9s %9s %9s %9s %8s\n", "map", "heuristic", "found", "expanded", "p50 us", "p90 us", "p99 us", "max us", "allocs");
+	for (unsigned int m = 0; m < maps.size(); m++)
+	{
+		std::vector<Query> queries = GenerateQueries(maps[m], nrOfQueries);
+		for (int h = 0; h < 5 && !queries.empty(); h++)
+		{
+			Measurement measurement = Run(maps[m], queries, HEURISTICS[h]);
+			std::sort(measurement._microseconds.begin(), measurement._microseconds.end());
+			printf("%-10s %-11s %6.1f%% %10.1f %9.1f %9.1f %9.1f %9.1f %8.2f\n", maps[m]._name.c_str(), HEURISTIC_NAMES[h],
+				100.0 * measurement._nrOfFound / queries.size(), (double)measurement._nrOfExpandedNodes / queries.size(),
+				GetPercentile(measurement._microseconds, 50.0), GetPercentile(measurement._microseconds, 90.0),
+				GetPercentile(measurement._microseconds, 99.0), measurement._microseconds.back(),
+				(double)measurement._nrOfAllocations / queries.size());
+		}
+	}
+	return 0;
+}
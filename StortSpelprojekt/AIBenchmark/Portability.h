@@ -0,0 +1,10 @@
+#pragma once
+/*
+	Stand-ins for the MSVC extensions used by the AI headers, so they can be built with other compilers.
+	Has to be included before any AI header.
+*/
+#ifndef _MSC_VER
+#define __declspec(x)
+#define __int8 char
+#define __int16 short
+#endif
@@ -126,7 +126,7 @@ Texture* AssetManager::ScanTexture(const std::string& name)
 {
 	if (name.empty())
 	{
-		throw exception("ScanTexture: Name is empty");
+		throw runtime_error("ScanTexture: Name is empty");
 	}
 
 	Texture* texture = new Texture;
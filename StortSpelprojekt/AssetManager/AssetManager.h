@@ -11,7 +11,7 @@
 #include "RenderUtils.h"
 #include "LevelFormat.h"
 #include "CommonUtils.h"
-#include "cereal\cereal.hpp"
+#include "cereal/cereal.hpp"
 
 using namespace std;
 using namespace DirectX;
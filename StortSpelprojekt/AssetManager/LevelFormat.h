@@ -3,11 +3,11 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <cereal\archives\binary.hpp>
-#include <cereal\archives\json.hpp>
-#include <cereal\types\vector.hpp>
-#include <cereal\types\string.hpp>
-#include <cereal\types\array.hpp>
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/array.hpp>
 
 namespace Level
 {
@@ -0,0 +1,347 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cereal/archives/xml.hpp>
+#include "ObjectHandler.h"
+#include "AmbientLight.h"
+#include "Unit.h"
+
+/*
+Plays a level through ObjectHandler without a window, renderer or sound device, as fast as the CPU allows.
+Run from the game directory so Assets is found:
+
+	HeadlessSimulation <level binary> [placement script] [--runs N] [--ticks N]
+
+The placement script places guards, traps and cameras before the level starts, like the placement state does.
+One object per line, in tilemap coordinates, with the rotation in degrees in steps of 45:
+
+	guard <subType> <x> <z> [rotation]
+	trap <subType> <x> <z> [rotation]
+	camera <subType> <x> <z> [rotation]
+
+Everything after # is a comment. Every run is played to the end the game would show, lost when loot is stolen and
+won when no enemy is left to come, or stopped after the tick limit.
+*/
+
+struct Placement
+{
+	System::Type _type;
+	int _subType;
+	int _x;
+	int _z;
+	int _rotation;
+};
+
+enum Outcome { WIN, LOSE, TIMEOUT, NR_OF_OUTCOMES };
+static const char* OUTCOME_NAMES[NR_OF_OUTCOMES] = { "WIN", "LOSE", "TIMEOUT" };
+
+struct RunResult
+{
+	Outcome _outcome;
+	unsigned int _ticks;
+	double _wallSeconds;
+	unsigned int _nrOfLoot;
+	unsigned int _nrOfLootLeft;
+	unsigned int _nrOfGuardsPlaced;
+	unsigned int _nrOfGuardsLeft;
+	unsigned int _nrOfTraps;
+	int _nrOfEnemiesSpawned;
+	unsigned int _nrOfEnemiesLeft;
+};
+
+static void PrintUsage()
+{
+	printf("Usage: HeadlessSimulation <level binary> [placement script] [--runs N] [--ticks N]\n");
+	printf("Run from the game directory, the level binary is usually in %s or %s\n", System::CAMPAIGN_FOLDER_PATH.c_str(), System::SKIRMISH_FOLDER_PATH.c_str());
+}
+
+static bool ParsePlacementScript(const std::string& fileName, std::vector<Placement>& placements)
+{
+	std::ifstream file(fileName);
+	if (!file.is_open())
+	{
+		printf("Could not open placement script %s\n", fileName.c_str());
+		return false;
+	}
+
+	std::string line;
+	for (int lineNumber = 1; std::getline(file, line); lineNumber++)
+	{
+		line = line.substr(0, line.find('#'));
+		std::istringstream words(line);
+		std::string typeName;
+		if (!(words >> typeName))
+		{
+			continue;
+		}
+
+		Placement placement;
+		placement._rotation = 0;
+		if (typeName == "guard")
+		{
+			placement._type = System::GUARD;
+		}
+		else if (typeName == "trap")
+		{
+			placement._type = System::TRAP;
+		}
+		else if (typeName == "camera")
+		{
+			placement._type = System::CAMERA;
+		}
+		else
+		{
+			printf("%s:%d: unknown type %s\n", fileName.c_str(), lineNumber, typeName.c_str());
+			return false;
+		}
+
+		if (!(words >> placement._subType >> placement._x >> placement._z))
+		{
+			printf("%s:%d: expected <type> <subType> <x> <z> [rotation]\n", fileName.c_str(), lineNumber);
+			return false;
+		}
+		words >> placement._rotation;
+		placements.push_back(placement);
+	}
+	return true;
+}
+
+/*
+Rotating by 45 degrees clockwise steps the direction once in AI::CLOCKWISE_ROTATION, starting from {1, 0} as the
+placement state does
+*/
+static unsigned int Place(ObjectHandler* objectHandler, const std::vector<Placement>& placements)
+{
+	unsigned int nrOfPlaced = 0;
+	for (const Placement& placement : placements)
+	{
+		System::Blueprint* blueprint = objectHandler->GetBlueprintByType(placement._type, placement._subType);
+		GameObject* object = nullptr;
+		if (blueprint != nullptr)
+		{
+			int steps = ((placement._rotation / 45) % 8 + 8) % 8;
+			XMFLOAT3 position((float)placement._x, 0.0f, (float)placement._z);
+			XMFLOAT3 rotation(0.0f, (placement._rotation * DirectX::XM_PI) / 180.0f, 0.0f);
+			object = objectHandler->Add(blueprint, 0, position, rotation, true, AI::CLOCKWISE_ROTATION[(steps + 4) % 8]);
+		}
+
+		if (object != nullptr)
+		{
+			nrOfPlaced++;
+		}
+		else
+		{
+			printf("Could not place type %d, subtype %d at (%d, %d)\n", placement._type, placement._subType, placement._x, placement._z);
+		}
+	}
+	return nrOfPlaced;
+}
+
+/*
+The particle system is not updated headless, so its requests are dropped after every tick, as ParticleHandler
+deletes them once read
+*/
+static void DropParticleMessages(std::vector<ParticleMessage*>* particleMessages)
+{
+	for (ParticleMessage* message : *particleMessages)
+	{
+		delete message;
+	}
+	particleMessages->clear();
+}
+
+/*
+Returns false if the level could not be loaded, the result is only filled in if it could
+*/
+static bool Run(ObjectHandler* objectHandler, std::vector<ParticleMessage*>* particleMessages, Level::LevelBinary& levelData,
+	const std::vector<Placement>& placements, unsigned int maxTicks, float msPerTick, RunResult& result)
+{
+	result = {};
+	if (!objectHandler->LoadLevel(levelData, true))
+	{
+		objectHandler->UnloadLevel();
+		DropParticleMessages(particleMessages);
+		return false;
+	}
+	Place(objectHandler, placements);
+
+	//The same start as PlayState and GameLogic
+	result._nrOfLoot = objectHandler->GetAllByType(System::LOOT)->size();
+	for (GameObject* guard : *objectHandler->GetAllByType(System::GUARD))
+	{
+		static_cast<Unit*>(guard)->InitializePathFinding();
+	}
+	std::vector<std::vector<GameObject*>>* gameObjects = objectHandler->GetGameObjects();
+	for (auto& gameObjectVector : *gameObjects)
+	{
+		std::sort(gameObjectVector.begin(), gameObjectVector.end(),
+			[](GameObject* first, GameObject* second)
+		{
+			return *first < *second;
+		}
+		);
+	}
+	result._nrOfGuardsPlaced = objectHandler->GetAllByType(System::GUARD)->size();
+	result._nrOfTraps = objectHandler->GetAllByType(System::TRAP)->size();
+	int nrOfEnemiesToSpawn = objectHandler->GetRemainingToSpawn();
+
+	result._outcome = TIMEOUT;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (result._ticks < maxTicks)
+	{
+		//Checked before every update, as GameLogic::CheckGameStatus does
+		if (objectHandler->GetAllByType(System::LOOT)->size() < result._nrOfLoot)
+		{
+			result._outcome = LOSE;
+			break;
+		}
+		if (objectHandler->GetAllByType(System::ENEMY)->size() <= 0 && objectHandler->GetRemainingToSpawn() <= 0)
+		{
+			result._outcome = WIN;
+			break;
+		}
+
+		objectHandler->BeginTick();
+		objectHandler->Update(msPerTick);
+		DropParticleMessages(particleMessages);
+		result._ticks++;
+	}
+	result._wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	result._nrOfLootLeft = objectHandler->GetAllByType(System::LOOT)->size();
+	result._nrOfGuardsLeft = objectHandler->GetAllByType(System::GUARD)->size();
+	result._nrOfEnemiesSpawned = nrOfEnemiesToSpawn - objectHandler->GetRemainingToSpawn();
+	result._nrOfEnemiesLeft = objectHandler->GetAllByType(System::ENEMY)->size();
+
+	objectHandler->UnloadLevel();
+	DropParticleMessages(particleMessages);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string levelFileName;
+	std::string scriptFileName;
+	unsigned int nrOfRuns = 1;
+	unsigned int maxTicks = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		if ((argument == "--runs" || argument == "--ticks") && i + 1 < argc)
+		{
+			unsigned int value = (unsigned int)strtoul(argv[++i], nullptr, 10);
+			(argument == "--runs" ? nrOfRuns : maxTicks) = value;
+		}
+		else if (levelFileName.empty())
+		{
+			levelFileName = argument;
+		}
+		else if (scriptFileName.empty())
+		{
+			scriptFileName = argument;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (levelFileName.empty() || nrOfRuns == 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+	std::vector<Placement> placements;
+	if (!scriptFileName.empty() && !ParsePlacementScript(scriptFileName, placements))
+	{
+		return 1;
+	}
+
+	//Only the tick rate is used, read from the same file as the game does in debug. As in SettingsReader::LoadXML,
+	//a file saved before a field was added throws when it is missed, and the rest keeps its default
+	System::Settings settings;
+	std::ifstream settingsFile("Assets/settings.xml");
+	if (settingsFile.is_open())
+	{
+		try
+		{
+			cereal::XMLInputArchive archive(settingsFile);
+			archive(settings);
+		}
+		catch (const cereal::Exception&) {}
+	}
+	float msPerTick = 1000.0f / (float)max(settings._ticksPerSecond, 1u);
+	if (maxTicks == 0)
+	{
+		maxTicks = settings._ticksPerSecond * 60 * 30;		//Half an hour of game time
+	}
+
+	srand((unsigned int)time(NULL));
+
+	System::SoundModule soundModule(&settings, "Assets/Sounds/", ".ogg");
+	std::vector<ParticleMessage*> particleMessages;
+	Renderer::ParticleEventQueue particleEventQueue(&particleMessages);
+	AmbientLight ambientLight;
+	ID3D11Device device;
+	//Declared in this order so the object handler is destroyed before the assets it uses, also on the early returns
+	std::unique_ptr<AssetManager> assetManager(new AssetManager(&device));
+	GameObjectInfo data;
+	std::unique_ptr<ObjectHandler> objectHandler(new ObjectHandler(&device, assetManager.get(), &data, &settings, &particleEventQueue, &soundModule, &ambientLight));
+
+	//Parsed once and loaded for every run, ObjectHandler::LoadLevel(path) would quietly load an empty level from a bad file
+	Level::LevelBinary levelData;
+	if (assetManager->ParseLevelBinary(&levelData, levelFileName) != S_OK)
+	{
+		printf("Could not read level %s\n", levelFileName.c_str());
+		return 1;
+	}
+
+	unsigned int nrOfOutcomes[NR_OF_OUTCOMES] = {};
+	unsigned long long totalTicks = 0;
+	double totalWallSeconds = 0.0;
+	for (unsigned int i = 0; i < nrOfRuns; i++)
+	{
+		RunResult result;
+		try
+		{
+			if (!Run(objectHandler.get(), &particleMessages, levelData, placements, maxTicks, msPerTick, result))
+			{
+				printf("Run %u failed: could not load level %s\n", i + 1, levelFileName.c_str());
+				return 1;
+			}
+		}
+		catch (const std::exception& e)
+		{
+			//Most likely a model or animation missing from Assets
+			printf("Run %u failed: %s\n", i + 1, e.what());
+			return 1;
+		}
+
+		double simulatedSeconds = result._ticks * msPerTick * 0.001;
+		printf("Run %u: %s after %u ticks, %.1f s simulated in %.3f s (%.0fx)\n", i + 1, OUTCOME_NAMES[result._outcome], result._ticks,
+			simulatedSeconds, result._wallSeconds, result._wallSeconds > 0.0 ? simulatedSeconds / result._wallSeconds : 0.0);
+		printf("\tLoot %u/%u, guards %u/%u, traps %u, enemies spawned %d, enemies left %u\n", result._nrOfLootLeft, result._nrOfLoot,
+			result._nrOfGuardsLeft, result._nrOfGuardsPlaced, result._nrOfTraps, result._nrOfEnemiesSpawned, result._nrOfEnemiesLeft);
+
+		nrOfOutcomes[result._outcome]++;
+		totalTicks += result._ticks;
+		totalWallSeconds += result._wallSeconds;
+	}
+
+	if (nrOfRuns > 1)
+	{
+		printf("%u runs: %u won, %u lost, %u timed out, %.1f ticks on average, %.0f ticks per second\n", nrOfRuns, nrOfOutcomes[WIN], nrOfOutcomes[LOSE],
+			nrOfOutcomes[TIMEOUT], (double)totalTicks / nrOfRuns, totalWallSeconds > 0.0 ? totalTicks / totalWallSeconds : 0.0);
+	}
+
+	return 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+/*
+	Stand-ins for the MSVC extensions used by the game headers, so they can be built with other compilers.
+	Included before every source file of the headless build.
+*/
+#ifndef _MSC_VER
+#include <cstddef>
+#include <mm_malloc.h>
+
+#define __declspec(x)
+#define __int8 char
+#define __int16 short
+
+#define _aligned_malloc(size, alignment) _mm_malloc((size), (alignment))
+#define _aligned_free(memory) _mm_free(memory)
+#endif
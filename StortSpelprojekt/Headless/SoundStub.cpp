@@ -0,0 +1,67 @@
+#include "SoundModule.h"
+
+/*
+The headless build behaves like the game does when no sound device is connected: the module is never initiated,
+so nothing is loaded or played and no YSE or COM call is made.
+*/
+namespace System
+{
+	SoundModule::SoundModule(System::Settings* settings, const std::string &stdPath, const std::string &extension)
+	{
+		_allSounds = new std::map<std::string, YSE::sound*>;
+		_initiated = false;
+		_stdPath = stdPath;
+		_soundExtension = extension;
+	}
+
+	SoundModule::~SoundModule()
+	{
+		delete _allSounds;
+	}
+
+	bool SoundModule::AddSound(const std::string &fileName, float volume, float speed, bool relative, bool looping, bool streaming)
+	{
+		return false;
+	}
+
+	bool SoundModule::RemoveSound(const std::string &fileName)
+	{
+		return false;
+	}
+
+	void SoundModule::Update(const DirectX::XMFLOAT3& position) {}
+
+	bool SoundModule::Play(const std::string &fileName)
+	{
+		return false;
+	}
+
+	bool SoundModule::Pause(const std::string &fileName)
+	{
+		return false;
+	}
+
+	bool SoundModule::Stop(const std::string &fileName)
+	{
+		return false;
+	}
+
+	bool SoundModule::Stop(const std::string &fileName, int fadeTime)
+	{
+		return false;
+	}
+
+	bool SoundModule::HardStop(const std::string &fileName)
+	{
+		return false;
+	}
+
+	void SoundModule::SetSoundPosition(const std::string &fileName, float x, float y, float z) {}
+
+	void SoundModule::SetVolume(float volume, int channel) {}
+
+	float SoundModule::GetVolume(int channel)
+	{
+		return 0.0f;
+	}
+}
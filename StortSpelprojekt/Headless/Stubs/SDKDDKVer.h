@@ -0,0 +1,2 @@
+#pragma once
+//Stand-in for the Windows SDK version header in the headless build
@@ -0,0 +1,2 @@
+#pragma once
+//Stand-in for the MSVC debug heap header in the headless build, which has no debug heap
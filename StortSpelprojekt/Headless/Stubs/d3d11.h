@@ -0,0 +1,91 @@
+#pragma once
+/*
+	Stand-in for d3d11.h in the headless build. The device hands out empty, reference counted objects that hold
+	no data, so the game logic can load levels and models and release them again without a GPU, as long as it
+	never draws.
+*/
+#include "windows.h"
+
+#ifndef _In_
+#define _In_
+#define _In_opt_
+#define _In_z_
+#define _Out_opt_
+#define _Outptr_opt_
+#define _In_reads_(exp)
+#define _In_reads_opt_(exp)
+#define _In_reads_bytes_(exp)
+#define _Out_writes_(exp)
+#endif
+
+enum D3D11_USAGE
+{
+	D3D11_USAGE_DEFAULT,
+	D3D11_USAGE_IMMUTABLE,
+	D3D11_USAGE_DYNAMIC,
+	D3D11_USAGE_STAGING
+};
+
+enum D3D11_BIND_FLAG
+{
+	D3D11_BIND_VERTEX_BUFFER = 0x1,
+	D3D11_BIND_INDEX_BUFFER = 0x2,
+	D3D11_BIND_CONSTANT_BUFFER = 0x4,
+	D3D11_BIND_SHADER_RESOURCE = 0x8
+};
+
+struct D3D11_BUFFER_DESC
+{
+	unsigned int ByteWidth;
+	D3D11_USAGE Usage;
+	unsigned int BindFlags;
+	unsigned int CPUAccessFlags;
+	unsigned int MiscFlags;
+	unsigned int StructureByteStride;
+};
+
+struct D3D11_SUBRESOURCE_DATA
+{
+	const void* pSysMem;
+	unsigned int SysMemPitch;
+	unsigned int SysMemSlicePitch;
+};
+
+struct ID3D11DeviceChild
+{
+	unsigned long _refCount = 1;
+
+	virtual ~ID3D11DeviceChild() {}
+
+	unsigned long AddRef()
+	{
+		return ++_refCount;
+	}
+
+	unsigned long Release()
+	{
+		unsigned long refCount = --_refCount;
+		if (refCount == 0)
+		{
+			delete this;
+		}
+		return refCount;
+	}
+};
+
+struct ID3D11Resource : ID3D11DeviceChild {};
+struct ID3D11Buffer : ID3D11Resource {};
+struct ID3D11ShaderResourceView : ID3D11DeviceChild {};
+struct ID3D11DeviceContext : ID3D11DeviceChild {};
+
+struct ID3D11Device : ID3D11DeviceChild
+{
+	HRESULT CreateBuffer(const D3D11_BUFFER_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Buffer** buffer)
+	{
+		if (buffer != nullptr)
+		{
+			*buffer = new ID3D11Buffer();
+		}
+		return S_OK;
+	}
+};
@@ -0,0 +1,2 @@
+#pragma once
+#include "d3d11.h"
@@ -0,0 +1,2 @@
+#pragma once
+//Stand-in for the audio device header in the headless build, which has no sound device
@@ -0,0 +1,13 @@
+#pragma once
+/*
+	Stand-in for shlobj.h in the headless build. There is no documents folder, so it is the working directory
+*/
+#include "windows.h"
+
+#define CSIDL_MYDOCUMENTS 0x0005
+
+inline HRESULT SHGetFolderPathA(HWND, int, HANDLE, DWORD, char* path)
+{
+	strcpy(path, ".");
+	return S_OK;
+}
@@ -0,0 +1,59 @@
+#pragma once
+/*
+	Stand-in for the parts of the Windows SDK that the game logic reaches through its headers.
+	Only the headless build sees this, the Visual Studio build uses the real windows.h.
+*/
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cfloat>
+#include <climits>
+#include <algorithm>
+
+typedef long HRESULT;
+typedef void* HANDLE;
+typedef void* HWND;
+typedef unsigned long DWORD;
+
+#define S_OK ((HRESULT)0L)
+#define S_FALSE ((HRESULT)1L)
+#define E_FAIL ((HRESULT)0x80004005L)
+#define E_OUTOFMEMORY ((HRESULT)0x8007000EL)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+
+#define MAX_PATH 260
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define FILE_ATTRIBUTE_DIRECTORY 0x00000010
+#define ZeroMemory(destination, length) memset((destination), 0, (length))
+
+//The game code calls min and max unqualified, as the macros of windows.h
+using std::min;
+using std::max;
+
+//Directories are never listed or created, the headless build only reads the files it is given
+struct WIN32_FIND_DATA
+{
+	DWORD dwFileAttributes;
+	char cFileName[MAX_PATH];
+};
+
+inline HANDLE FindFirstFile(const char*, WIN32_FIND_DATA*)
+{
+	return INVALID_HANDLE_VALUE;
+}
+
+inline int FindNextFile(HANDLE, WIN32_FIND_DATA*)
+{
+	return 0;
+}
+
+inline int FindClose(HANDLE)
+{
+	return 1;
+}
+
+inline int CreateDirectory(const char*, void*)
+{
+	return 0;
+}
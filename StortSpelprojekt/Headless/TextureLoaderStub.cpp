@@ -0,0 +1,23 @@
+#include "DDSTextureLoader.h"
+
+/*
+The textures are never sampled in the headless build, so no file is read. Every texture gets an empty view that
+is released like a real one when its last user is gone.
+*/
+HRESULT DirectX::CreateDDSTextureFromFileEx(ID3D11Device* d3dDevice, const wchar_t* szFileName, size_t maxsize, D3D11_USAGE usage, unsigned int bindFlags,
+	unsigned int cpuAccessFlags, unsigned int miscFlags, bool forceSRGB, ID3D11Resource** texture, ID3D11ShaderResourceView** textureView, DDS_ALPHA_MODE* alphaMode)
+{
+	if (texture != nullptr)
+	{
+		*texture = new ID3D11Resource();
+	}
+	if (textureView != nullptr)
+	{
+		*textureView = new ID3D11ShaderResourceView();
+	}
+	if (alphaMode != nullptr)
+	{
+		*alphaMode = DDS_ALPHA_MODE_UNKNOWN;
+	}
+	return S_OK;
+}
@@ -3,9 +3,9 @@
 #include <d3d11.h>
 #include <vector>
 #include <string>
-#include <cereal\archives\json.hpp>
-#include <cereal\types\string.hpp>
-#include <cereal\types\vector.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
 #include "../RenderUtils.h"
 
 //Determines how it moves
@@ -12,6 +12,8 @@ namespace Renderer
 		_shaderHandler = new ShaderHandler(_d3d->GetDevice());
 		_antialiasingEnabled = true;
 		_shadowsEnabled = true;
+		_instanceBuffer = nullptr;
+		_instanceBufferCapacity = 0;
 
 		InitializeScreenQuadBuffer();
 		InitializeConstantBuffers();
@@ -35,6 +37,7 @@ namespace Renderer
 		_matrixBufferLightPassPerSpotlight->Release();
 		_matrixBufferLightPassPerPointlight->Release();
 		_matrixBufferParticles->Release();
+		SAFE_RELEASE(_instanceBuffer);
 	}
 
 	void RenderModule::InitializeScreenQuadBuffer()
@@ -294,6 +297,56 @@ namespace Renderer
 		deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &vs, &offset);
 	}
 
+	/*
+	The instance buffer only grows, doubling its size, so it is rarely recreated
+	*/
+	void RenderModule::SetInstanceData(const InstanceData* instances, int nrOfInstances)
+	{
+		HRESULT result;
+		ID3D11DeviceContext* deviceContext = _d3d->GetDeviceContext();
+
+		if (nrOfInstances <= 0)
+		{
+			return;
+		}
+
+		if (nrOfInstances > _instanceBufferCapacity)
+		{
+			SAFE_RELEASE(_instanceBuffer);
+			_instanceBufferCapacity = max(256, _instanceBufferCapacity);
+			while (_instanceBufferCapacity < nrOfInstances)
+			{
+				_instanceBufferCapacity *= 2;
+			}
+
+			D3D11_BUFFER_DESC bufferDesc;
+			ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+			bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+			bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+			bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			bufferDesc.ByteWidth = sizeof(InstanceData) * _instanceBufferCapacity;
+			result = _d3d->GetDevice()->CreateBuffer(&bufferDesc, NULL, &_instanceBuffer);
+			if (FAILED(result))
+			{
+				_instanceBufferCapacity = 0;
+				throw std::runtime_error("RenderModule::SetInstanceData: Failed to create _instanceBuffer");
+			}
+		}
+
+		D3D11_MAPPED_SUBRESOURCE mappedResource;
+		result = deviceContext->Map(_instanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		if (FAILED(result))
+		{
+			throw std::runtime_error("RenderModule::SetInstanceData: Failed to Map _instanceBuffer");
+		}
+		memcpy(mappedResource.pData, instances, sizeof(InstanceData) * nrOfInstances);
+		deviceContext->Unmap(_instanceBuffer, 0);
+
+		UINT32 offset = 0;
+		UINT32 instanceSize = sizeof(InstanceData);
+		deviceContext->IASetVertexBuffers(1, 1, &_instanceBuffer, &instanceSize, &offset);
+	}
+
 	void RenderModule::SetDataPerLineList(ID3D11Buffer* lineList, int vertexSize)
 	{
 		//This might seem like a useless function, but SetDataPerMesh should be private to prevent people from using it the wrong way.
@@ -476,6 +529,16 @@ namespace Renderer
 
 			break;
 		}
+		case GEO_PASS_INSTANCED:
+		{
+			_d3d->SetBlendState(Renderer::DirectXHandler::BlendState::DISABLE);
+			_d3d->SetCullingState(Renderer::DirectXHandler::CullingState::BACK);
+			deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+			_d3d->SetGeometryStage();
+			_shaderHandler->SetGeometryInstancedStageShaders(deviceContext);
+
+			break;
+		}
 		case AA_STAGE:
 		{
 			deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -600,6 +663,11 @@ namespace Renderer
 		_d3d->GetDeviceContext()->Draw(vertexBufferSize, 0);
 	}
 
+	void RenderModule::RenderInstanced(int vertexBufferSize, int firstInstance, int nrOfInstances)
+	{
+		_d3d->GetDeviceContext()->DrawInstanced(vertexBufferSize, nrOfInstances, 0, firstInstance);
+	}
+
 	void RenderModule::Render(GUI::Node* root, FontWrapper* fontWrapper, int brightness)
 	{
 		ID3D11DeviceContext* deviceContext = _d3d->GetDeviceContext();
@@ -27,6 +27,10 @@ Constant buffer register setup:
 |    6    |    PerBillboardedObject. Holds necessary data used to generate for example billboarded particles. Geometry shader								  |
 ---------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+Instanced rendering:
+~ The instanced geometry pass reads the world matrix and color offset from the instance buffer in vertex buffer slot 1 instead of PerObject.
+  Upload the instances of the whole frame with SetInstanceData, then draw ranges of them with RenderInstanced.
+
 Render targets:
 -----Name-----------Pos-------Description----------------------------------------------------------------------------------------------------------------------
 |	 Backbuffer	     x    |   This is the render target that is ultimately drawn to the screen in EndScene. Does not have a shader resource view              |
@@ -144,6 +148,8 @@ namespace Renderer
 		ID3D11Buffer*		_selectionQuad;
 		ID3D11Buffer*		_matrixBufferHUD;
 		ID3D11Buffer*		_matrixBufferParticles;
+		ID3D11Buffer*		_instanceBuffer;
+		int					_instanceBufferCapacity;	//Number of instances _instanceBuffer has room for
 
 		DirectXHandler*		_d3d;
 		ShaderHandler*		_shaderHandler;
@@ -167,7 +173,7 @@ namespace Renderer
 		ShadowMap* _shadowMap;
 
 	public:
-		enum ShaderStage { GEO_PASS, SHADOW_GENERATION, LIGHT_APPLICATION_SPOTLIGHT, LIGHT_APPLICATION_POINTLIGHT, RENDER_LINESTRIP, ANIM_STAGE, HUD_STAGE, AA_STAGE, BILLBOARDING_STAGE, ANIM_SHADOW_GENERATION };
+		enum ShaderStage { GEO_PASS, SHADOW_GENERATION, LIGHT_APPLICATION_SPOTLIGHT, LIGHT_APPLICATION_POINTLIGHT, RENDER_LINESTRIP, ANIM_STAGE, HUD_STAGE, AA_STAGE, BILLBOARDING_STAGE, ANIM_SHADOW_GENERATION, GEO_PASS_INSTANCED };
 
 		RenderModule(HWND hwnd, System::Settings* settings);
 		~RenderModule();
@@ -177,6 +183,7 @@ namespace Renderer
 		void SetDataPerFrame(DirectX::XMMATRIX* view, DirectX::XMMATRIX* projection);
 		void SetDataPerObjectType(RenderObject* renderObject);
 		void SetDataPerLineList(ID3D11Buffer* lineList, int vertexSize);
+		void SetInstanceData(const InstanceData* instances, int nrOfInstances);
 		void SetDataPerParticleEmitter(const DirectX::XMFLOAT3& position, DirectX::XMMATRIX* camView, DirectX::XMMATRIX* camProjection, 
 									   const DirectX::XMFLOAT3& camPos, float scale, ID3D11ShaderResourceView** textures, int textureCount, int isIcon);
 
@@ -197,6 +204,7 @@ namespace Renderer
 		void BeginScene(float red, float green, float blue, float alpha, bool clearBackBuffer);
 		void Render(DirectX::XMMATRIX* world, int vertexBufferSize, const DirectX::XMFLOAT3& colorOffset = DirectX::XMFLOAT3(0, 0, 0));
 		void RenderAnimation(DirectX::XMMATRIX* world, int vertexBufferSize, DirectX::XMMATRIX* extra, int bonecount, const DirectX::XMFLOAT3& colorOffset = DirectX::XMFLOAT3(0, 0, 0));
+		void RenderInstanced(int vertexBufferSize, int firstInstance, int nrOfInstances);
 		void Render(GUI::Node* root, FontWrapper* fontWrapper, int brightness);
 		void RenderLineStrip(DirectX::XMMATRIX* world, int nrOfPoints, const DirectX::XMFLOAT3& colorOffset = DirectX::XMFLOAT3(0,0,0));
 		void RenderShadowMap(DirectX::XMMATRIX* world, int vertexBufferSize, DirectX::XMMATRIX* animTransformData = nullptr, int bonecount = 0);
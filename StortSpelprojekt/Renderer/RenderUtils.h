@@ -188,4 +188,14 @@ struct RenderObject
 	{
 		return !(*this == other);
 	}
+};
+
+/*
+Per instance vertex data of the instanced geometry pass. The world matrix is not transposed,
+its rows are read as the four WORLD elements
+*/
+struct InstanceData
+{
+	DirectX::XMMATRIX _world;
+	DirectX::XMFLOAT4 _colorOffset;
 };
\ No newline at end of file
@@ -101,6 +101,22 @@ namespace Renderer
 		_geoPassVS = CreateVertexShader(device, L"Assets/Shaders/GeoVS.hlsl", inputDesc, numElements);
 		_geoPassPS = CreatePixelShader(device, L"Assets/Shaders/GeoPS.hlsl");
 
+		//The vertices are in slot 0 and the instances in slot 1
+		D3D11_INPUT_ELEMENT_DESC instancedInputDesc[] =
+		{
+			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+			{ "WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+			{ "WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+			{ "WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+			{ "COLOROFFSET", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		};
+
+		numElements = sizeof(instancedInputDesc) / sizeof(instancedInputDesc[0]);
+		_geoPassInstancedVS = CreateVertexShader(device, L"Assets/Shaders/GeoInstancedVS.hlsl", instancedInputDesc, numElements);
+
 		D3D11_INPUT_ELEMENT_DESC lightInputDesc[] =
 		{
 			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
@@ -180,6 +196,7 @@ namespace Renderer
 	ShaderHandler::~ShaderHandler()
 	{
 		delete _geoPassVS;
+		delete _geoPassInstancedVS;
 		delete _passthroughVS;
 		delete _animPassVS;
 		delete _shadowMapVS;
@@ -425,6 +442,20 @@ namespace Renderer
 		deviceContext->PSSetSamplers(0, 1, &_samplerWRAP);
 	}
 
+	void ShaderHandler::SetGeometryInstancedStageShaders(ID3D11DeviceContext * deviceContext)
+	{
+		// Set vertex layout
+		deviceContext->IASetInputLayout(_geoPassInstancedVS->_inputLayout);
+
+		// Set shaders
+		deviceContext->VSSetShader(_geoPassInstancedVS->_vertexShader, nullptr, 0);
+		deviceContext->PSSetShader(_geoPassPS, nullptr, 0);
+		deviceContext->GSSetShader(nullptr, nullptr, 0);
+
+		//Set sampler
+		deviceContext->PSSetSamplers(0, 1, &_samplerWRAP);
+	}
+
 	void ShaderHandler::SetAnimationPassShaders(ID3D11DeviceContext* deviceContext)
 	{
 		// Set vertex layout
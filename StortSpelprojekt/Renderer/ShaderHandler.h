@@ -30,6 +30,7 @@ namespace Renderer
 
 		//Vertex shaders
 		VertexShaderData*		_geoPassVS;
+		VertexShaderData*		_geoPassInstancedVS;
 		VertexShaderData*		_passthroughVS;
 		VertexShaderData*		_animPassVS;
 		VertexShaderData*		_animShadowMapVS;
@@ -73,6 +74,7 @@ namespace Renderer
 		~ShaderHandler();
 
 		void SetGeometryStageShaders(ID3D11DeviceContext* deviceContext);
+		void SetGeometryInstancedStageShaders(ID3D11DeviceContext* deviceContext);
 		void SetAnimationPassShaders(ID3D11DeviceContext* deviceContext);
 		void SetLinestripShaders(ID3D11DeviceContext* deviceContest);
 		void SetAnimaShadowGenerationShaders(ID3D11DeviceContext* deviceContext);
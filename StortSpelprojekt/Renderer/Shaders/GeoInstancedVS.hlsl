@@ -0,0 +1,52 @@
+/*----------------------------------------------------------------------------------------------------------------------
+| Vertex shader used to transform instanced static geometry to the screenspace for rendering.						   |
+| Same as GeoVS, but the world matrix and color offset are read per instance instead of from matrixBufferPerObject	   |
+----------------------------------------------------------------------------------------------------------------------*/
+
+cbuffer matrixBufferPerFrame : register(b0)
+{
+	matrix viewMatrix;
+	matrix projectionMatrix;
+	float3 ambientLight;
+};
+
+struct VS_IN
+{
+	float3 pos			: POSITION;
+	float3 normal		: NORMAL;
+	float2 uv			: TEXCOORD;
+	float4 world0		: WORLD0;
+	float4 world1		: WORLD1;
+	float4 world2		: WORLD2;
+	float4 world3		: WORLD3;
+	float4 colorOffset	: COLOROFFSET;
+};
+
+struct VS_OUT
+{
+	float4 pos			: SV_POSITION;
+	float3 normal		: NORMAL;
+	float2 uv			: TEXCOORD;
+	float3 ambientLight : AMBIENT;
+	float3 colorOffset  : COLOROFFSET;
+};
+
+VS_OUT main(VS_IN input)
+{
+	VS_OUT output = (VS_OUT)0;
+
+	//The rows are sent as they are, so no transpose is needed
+	float4x4 worldMatrix = float4x4(input.world0, input.world1, input.world2, input.world3);
+
+	float4 pos = mul(float4(input.pos, 1.0f), worldMatrix);
+	pos = mul(pos, viewMatrix);
+	pos = mul(pos, projectionMatrix);
+
+	output.pos = pos;
+	output.normal = mul(input.normal, (float3x3)worldMatrix);
+	output.uv = input.uv;
+	output.ambientLight = ambientLight;
+	output.colorOffset = input.colorOffset.xyz;
+
+	return output;
+}
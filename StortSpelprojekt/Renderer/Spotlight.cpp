@@ -1,6 +1,7 @@
 #include "Spotlight.h"
 #include <vector>
 #include <stdexcept>
+#include <limits>
 
 using namespace DirectX;
 
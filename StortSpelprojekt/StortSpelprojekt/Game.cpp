@@ -18,6 +18,7 @@ Game::Game(HINSTANCE hInstance, int nCmdShow) :
 
 	_assetManager = new AssetManager(_renderModule->GetDevice());
 	_combinedMeshGenerator = new CombinedMeshGenerator(_renderModule->GetDevice(), _renderModule->GetDeviceContext());
+	_instanceBatcher = new InstanceBatcher();
 	_controls = new System::Controls(_window->GetHWND());
 	_fontWrapper = new FontWrapper(_renderModule->GetDevice(), L"Assets/Fonts/Calibri.ttf", L"Calibri");
 
@@ -38,6 +39,8 @@ Game::Game(HINSTANCE hInstance, int nCmdShow) :
 	_SM->Update(_timer.GetFrameTime());
 
 	_enemiesHasSpawned = false;
+	_accumulatedTime = 0.0f;
+	SetTickRate(settings);
 
 	//Set brightness
 	_ambientLight.SetScale(_settingsReader.GetSettings()->_brightness);
@@ -57,6 +60,7 @@ Game::~Game()
 	delete _fontWrapper;
 	delete _particleHandler;
 	delete _combinedMeshGenerator;
+	delete _instanceBatcher;
 	delete _assetManager;
 }
 
@@ -69,6 +73,12 @@ void Game::ResizeResources(System::Settings* settings)
 	_camera->Resize(settings);
 }
 
+void Game::SetTickRate(System::Settings* settings)
+{
+	_msPerTick = 1000.0f / (settings->_ticksPerSecond > 0 ? settings->_ticksPerSecond : 60);
+	_maxTicksPerFrame = settings->_maxTicksPerFrame > 0 ? settings->_maxTicksPerFrame : 1;
+}
+
 void Game::LoadParticleSystemData(ParticleTextures& particleTextures, ParticleModifierOffsets& modifiers)
 {
 	ParticleSystemData data;
@@ -155,6 +165,7 @@ bool Game::Update(float deltaTime)
 		_renderModule->SetAntialiasingEnabled(settings->_antialiasing);
 		_ambientLight.SetScale(settings->_brightness);
 		_objectHandler->UpdateLightIntensity();
+		SetTickRate(settings);
 	}
 
 	_controls->Update();
@@ -181,15 +192,35 @@ bool Game::Update(float deltaTime)
 	return run;
 }
 
-void Game::Render()
+/*
+interpolation is how far the frame is between the last tick and the next one, 0 to 1
+*/
+void Game::Render(float interpolation)
 {
 	_renderModule->SetAmbientLight(_ambientLight.GetAmbientLight());
 	_renderModule->BeginScene(0.0f, 0.5f, 0.5f, 1.0f, _SM->GetState() == LEVELEDITSTATE);
 	_renderModule->SetDataPerFrame(_camera->GetViewMatrix(), _camera->GetProjectionMatrix());
+	_objectHandler->UpdateTransforms(interpolation);
 
 	/*///////////////////////////////////////////////////////  Geometry pass  ////////////////////////////////////////////////////////////
 	Render the objects to the diffuse and normal resource views. Camera depth is also generated here.									*/
-	std::vector<std::vector<GameObject*>>* gameObjects = _objectHandler->GetGameObjects();
+	const LightCulling::ObjectSpan* gameObjects;
+	LightCulling::ObjectSpan allGameObjects[System::NR_OF_TYPES];
+	if (_SM->GetState() == PLAYSTATE || _SM->GetState() == PAUSESTATE)
+	{
+		//Only objects on the tilemap are in the quadtree, so the states with ghost images render everything
+		gameObjects = _objectHandler->GetObjectsInFrustum(_camera);
+	}
+	else
+	{
+		std::vector<std::vector<GameObject*>>* allObjects = _objectHandler->GetGameObjects();
+		for (int i = 0; i < System::NR_OF_TYPES; i++)
+		{
+			allGameObjects[i]._objects = allObjects->at(i).data();
+			allGameObjects[i]._size = allObjects->at(i).size();
+		}
+		gameObjects = allGameObjects;
+	}
 
 	/*-------------------------------------------------  Render non-skinned objects  ---------------------------------------------------*/
 	_renderModule->SetShaderStage(Renderer::RenderModule::ShaderStage::GEO_PASS);
@@ -232,7 +263,7 @@ void Game::Render()
 		{
 			if (spot.second->ShadowsEnabled())
 			{
-				if (spot.second != nullptr && spot.second->IsActive() && spot.first->IsActive())
+				if (spot.second != nullptr && spot.second->IsActive() && spot.first->IsActive() && _objectHandler->IsSpotlightInFrustum(spot.second))
 				{
 					GenerateShadowMap(Renderer::RenderModule::ShaderStage::SHADOW_GENERATION, spot.second, spot.first->GetID());
 					GenerateShadowMap(Renderer::RenderModule::ShaderStage::ANIM_SHADOW_GENERATION, spot.second, spot.first->GetID());
@@ -251,7 +282,7 @@ void Game::Render()
 		{
 			if (!spot.second->ShadowsEnabled())
 			{
-				if (spot.second != nullptr && spot.second->IsActive() && spot.first->IsActive())
+				if (spot.second != nullptr && spot.second->IsActive() && spot.first->IsActive() && _objectHandler->IsSpotlightInFrustum(spot.second))
 				{
 					_renderModule->SetShaderStage(Renderer::RenderModule::ShaderStage::LIGHT_APPLICATION_SPOTLIGHT);
 					_renderModule->SetLightDataPerSpotlight(spot.second);
@@ -291,7 +322,7 @@ void Game::Render()
 	_renderModule->EndScene();
 }
 
-void Game::RenderGameObjects(int forShaderStage, std::vector<std::vector<GameObject*>>* gameObjects)
+void Game::RenderGameObjects(int forShaderStage, const LightCulling::ObjectSpan* gameObjects)
 {
 	if (forShaderStage == Renderer::RenderModule::ShaderStage::GEO_PASS)
 	{
@@ -320,12 +351,13 @@ void Game::RenderGameObjects(int forShaderStage, std::vector<std::vector<GameObj
 		}
 	}
 
-	for (auto& gameObjectVector : *gameObjects)
+	for (int type = 0; type < System::NR_OF_TYPES; type++)
 	{
-		if (gameObjectVector.size() > 0)
+		const LightCulling::ObjectSpan& gameObjectVector = gameObjects[type];
+		if (gameObjectVector._size > 0)
 		{
 			//The floors in the gameObjects vector should not be rendered, as these are combined in a single mesh to reduce draw calls
-			if ((_SM->GetState() == PLACEMENTSTATE || _SM->GetState() == PLAYSTATE || _SM->GetState() == TUTORIAL || _SM->GetState() == PAUSESTATE) && (gameObjectVector.at(0)->GetType() == System::FLOOR || gameObjectVector.at(0)->GetType() == System::WALL))
+			if ((_SM->GetState() == PLACEMENTSTATE || _SM->GetState() == PLAYSTATE || _SM->GetState() == TUTORIAL || _SM->GetState() == PAUSESTATE) && (type == System::FLOOR || type == System::WALL))
 			{
 				continue;
 			}
@@ -333,9 +365,9 @@ void Game::RenderGameObjects(int forShaderStage, std::vector<std::vector<GameObj
 			GameObject* lastGameObject = nullptr;
 			RenderObject* lastRenderObject = nullptr;
 			int vertexBufferSize = 0;
-			for (uint j = 0; j < gameObjectVector.size(); j++)
+			for (uint j = 0; j < gameObjectVector._size; j++)
 			{
-				GameObject* gameObject = gameObjectVector[j];
+				GameObject* gameObject = gameObjectVector._objects[j];
 				RenderObject* renderObject = gameObject->GetRenderObject();
 
 				if ((forShaderStage == Renderer::RenderModule::ShaderStage::GEO_PASS && renderObject->_mesh->_isSkinned)
@@ -343,6 +375,13 @@ void Game::RenderGameObjects(int forShaderStage, std::vector<std::vector<GameObj
 				{
 					continue;
 				}
+				else if (forShaderStage == Renderer::RenderModule::ShaderStage::GEO_PASS)
+				{
+					if (gameObject->IsVisible())
+					{
+						_instanceBatcher->Add(renderObject, gameObject->GetMatrix(), gameObject->GetColorOffset());
+					}
+				}
 				else
 				{
 					if (lastGameObject == nullptr || *lastRenderObject != *renderObject || lastGameObject->GetSubType() != gameObject->GetSubType())
@@ -352,14 +391,7 @@ void Game::RenderGameObjects(int forShaderStage, std::vector<std::vector<GameObj
 					}
 					if (gameObject->IsVisible())
 					{
-						if (forShaderStage == Renderer::RenderModule::ShaderStage::GEO_PASS)
-						{
-							_renderModule->Render(gameObject->GetMatrix(), vertexBufferSize, gameObject->GetColorOffset());
-						}
-						else
-						{
-							_renderModule->RenderAnimation(gameObject->GetMatrix(), vertexBufferSize, gameObject->GetAnimation()->GetTransforms(), gameObject->GetAnimation()->GetBoneCount(), gameObject->GetColorOffset());
-						}
+						_renderModule->RenderAnimation(gameObject->GetMatrix(), vertexBufferSize, gameObject->GetAnimation()->GetTransforms(), gameObject->GetAnimation()->GetBoneCount(), gameObject->GetColorOffset());
 					}
 					lastGameObject = gameObject;
 					lastRenderObject = renderObject;
@@ -367,11 +399,25 @@ void Game::RenderGameObjects(int forShaderStage, std::vector<std::vector<GameObj
 			}
 		}
 	}
+
+	//Static objects are drawn with one instanced draw call per render object
+	if (forShaderStage == Renderer::RenderModule::ShaderStage::GEO_PASS && _instanceBatcher->GetNrOfInstances() > 0)
+	{
+		_instanceBatcher->Build();
+		_renderModule->SetShaderStage(Renderer::RenderModule::ShaderStage::GEO_PASS_INSTANCED);
+		_renderModule->SetInstanceData(_instanceBatcher->GetInstances(), _instanceBatcher->GetNrOfInstances());
+		for (const InstanceBatcher::Batch& batch : _instanceBatcher->GetBatches())
+		{
+			_renderModule->SetDataPerObjectType(batch._renderObject);
+			_renderModule->RenderInstanced(batch._renderObject->_mesh->_vertexBufferSize, batch._firstInstance, batch._nrOfInstances);
+		}
+	}
+	_instanceBatcher->Clear();
 }
 
 void Game::GenerateShadowMap(Renderer::RenderModule::ShaderStage shaderStage, Renderer::Spotlight* spotlight, unsigned short ownerID)
 {
-	vector<vector<GameObject*>>* inLight = _objectHandler->GetObjectsInLight(spotlight);
+	const LightCulling::ObjectSpan* inLight = _objectHandler->GetObjectsInLight(spotlight);
 	GameObject* lastGameObject = nullptr;
 	RenderObject* lastRenderObject = nullptr;
 	int vertexBufferSize = 0;
@@ -379,15 +425,16 @@ void Game::GenerateShadowMap(Renderer::RenderModule::ShaderStage shaderStage, Re
 	_renderModule->SetShaderStage(shaderStage);
 	_renderModule->SetShadowMapDataPerSpotlight(spotlight->GetViewMatrix(), spotlight->GetProjectionMatrix());
 
-	for (auto& j : *inLight)
+	for (int type = 0; type < System::NR_OF_TYPES; type++)
 	{
-		if (j.size() > 0)
+		const LightCulling::ObjectSpan& j = inLight[type];
+		if (j._size > 0)
 		{
 			vertexBufferSize = 0;
 
-			for (uint i = 0; i < j.size(); i++)
+			for (uint i = 0; i < j._size; i++)
 			{
-				GameObject* obj = j.at(i);
+				GameObject* obj = j._objects[i];
 				RenderObject* renderObject = obj->GetRenderObject();
 				Animation* anim;
 
@@ -525,29 +572,43 @@ int Game::Run()
 		else
 		{
 			_timer.Update();
-			if (_timer.GetFrameTime() >= MS_PER_FRAME)
+			if (_hasFocus)
 			{
-				if (_hasFocus)
+				if (_justGotFocus)
 				{
-					if (_justGotFocus)
-					{
-						ResizeResources(_settingsReader.GetSettings());
-						_justGotFocus = false;
-					}
+					ResizeResources(_settingsReader.GetSettings());
+					_justGotFocus = false;
+				}
 
-					run = Update(_timer.GetFrameTime());
+				/*
+				The game logic always advances in whole ticks of the same length, however long the frames take.
+				A slow frame is made up for with several ticks, but no more than _maxTicksPerFrame, since ticks that
+				take longer than they simulate would otherwise make every frame slower than the last
+				*/
+				_accumulatedTime += _timer.GetFrameTime();
+				unsigned int nrOfTicks = 0;
+				while (run && _accumulatedTime >= _msPerTick && nrOfTicks < _maxTicksPerFrame)
+				{
+					_objectHandler->BeginTick();
+					run = Update(_msPerTick);
+					_accumulatedTime -= _msPerTick;
+					nrOfTicks++;
+				}
+				if (_accumulatedTime >= _msPerTick)
+				{
+					_accumulatedTime = 0.0f;
+				}
 
-					if (run)
-					{
-						Render();
+				if (run)
+				{
+					Render(_accumulatedTime / _msPerTick);
 #ifdef _DEBUG
-						string s = to_string(_timer.GetFrameTime()) + " " + to_string(_timer.GetFPS());
-						SetWindowText(_window->GetHWND(), s.c_str());
+					string s = to_string(_timer.GetFrameTime()) + " " + to_string(_timer.GetFPS());
+					SetWindowText(_window->GetHWND(), s.c_str());
 #endif // DEBUG
-						_timer.Reset();
-					}
 				}
 			}
+			_timer.Reset();
 		}
 	}
 
@@ -20,13 +20,12 @@
 #include "ParticleSystem\ParticleUtils.h"
 #include "SettingsReader.h"
 #include "CombinedMeshGenerator.h"
+#include "InstanceBatcher.h"
 #include "AmbientLight.h"
 
 class Game
 {
 private:
-	const float	MS_PER_FRAME = 1000.0f / 60;
-
 	StateMachine*				_SM;
 	System::Window*				_window;
 	Renderer::RenderModule*		_renderModule;
@@ -43,18 +42,24 @@ private:
 	GameObjectInfo				_data;
 	System::SoundModule			_soundModule;
 	CombinedMeshGenerator*		_combinedMeshGenerator;
+	InstanceBatcher*			_instanceBatcher;
 
 	bool						_hasFocus;
 	bool						_justGotFocus;
 	bool						_enemiesHasSpawned;
 
+	float						_msPerTick;
+	unsigned int				_maxTicksPerFrame;
+	float						_accumulatedTime;	//Time not yet simulated, less than one tick unless catching up
+
 	//Resizing window, directx resources, camera
 	void ResizeResources(System::Settings* settings);
+	void SetTickRate(System::Settings* settings);
 
 	bool Update(float deltaTime);
-	void Render();
+	void Render(float interpolation);
 
-	void RenderGameObjects(int forShaderStage, std::vector<std::vector<GameObject*>>* gameObjects);
+	void RenderGameObjects(int forShaderStage, const LightCulling::ObjectSpan* gameObjects);
 	void GenerateShadowMap(Renderer::RenderModule::ShaderStage renderStage, Renderer::Spotlight* spotlight, unsigned short ownerID);
 	void RenderParticles();
 
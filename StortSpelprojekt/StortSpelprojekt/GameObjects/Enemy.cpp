@@ -12,7 +12,7 @@ void Enemy::Flee()
 	}
 	else
 	{
-		float distance = _aStar->GetHeuristicDistance(_tilePosition, _pursuer->GetTilePosition());
+		float distance = AI::GetOctileDistance(_tilePosition, _pursuer->GetTilePosition());
 		if (!_visible || distance > (float)_pursuer->GetVisionRadius())
 		{
 			_moveState = MoveState::IDLE;
@@ -113,7 +113,7 @@ Enemy::Enemy(unsigned short ID, DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 ro
 	: Unit(ID, position, rotation, tilePosition, type, renderObject, soundModule, particleEventQueue, tileMap, direction)
 {
 	_subType = enemyType;
-	_visibilityTimer = TIME_TO_HIDE;
+	_visibilityTimer = FramesToTicks(TIME_TO_HIDE);
 	_pursuer = nullptr;
 	_checkAllTilesTimer = -1;
 	_moveSpeed = 0.025f;
@@ -202,9 +202,9 @@ void Enemy::EvaluateTile(GameObject* obj)
 						AI::Vec2D* triggers = trap->GetTriggers();
 						for (int i = 0; i < trap->GetNrOfTriggerTiles(); i++)
 						{
-							if (_aStar->GetTileCost(triggers[i]) != 15)					//Arbitrary cost. Just make sure the getter and setter use the same number
+							if (GetTileCost(triggers[i]) != 15)					//Arbitrary cost. Just make sure the getter and setter use the same number
 							{
-								_aStar->SetTileCost(triggers[i], 15);
+								SetTileCost(triggers[i], 15);
 								changeRoute = true;
 							}
 						}
@@ -266,7 +266,7 @@ void Enemy::Act(GameObject* obj)
 				obj->SetTargeted(true);
 				_heldObject = obj;
 
-				if (System::FrameCountdown(_interactionTime, (int)_animation->GetLength(PICKUPOBJECTANIM)))
+				if (System::FrameCountdown(_interactionTime, FramesToTicks(_animation->GetLength(PICKUPOBJECTANIM))))
 				{
 					obj->SetVisibility(_visible);
 					ClearObjective();
@@ -286,7 +286,7 @@ void Enemy::Act(GameObject* obj)
 			if (static_cast<Trap*>(obj)->IsTrapActive())
 			{
 				Animate(DISABLETRAPANIM);
-				if (System::FrameCountdown(_interactionTime, (int)_animation->GetLength(DISABLETRAPANIM)))
+				if (System::FrameCountdown(_interactionTime, FramesToTicks(_animation->GetLength(DISABLETRAPANIM))))
 				{
 					DisarmTrap(static_cast<Trap*>(obj));
 					ClearObjective();
@@ -300,7 +300,7 @@ void Enemy::Act(GameObject* obj)
 		break;
 		case System::GUARD:
 			Animate(FIGHTANIM);
-			if (System::FrameCountdown(_interactionTime, (int)_animation->GetLength(FIGHTANIM)))
+			if (System::FrameCountdown(_interactionTime, FramesToTicks(_animation->GetLength(FIGHTANIM))))
 			{
 				if (static_cast<Unit*>(obj)->GetHealth() > 0 && InRange(obj->GetTilePosition()))
 				{
@@ -344,14 +344,14 @@ void Enemy::Update(float deltaTime)
 
 			if (_checkAllTilesTimer < 0)
 			{
-				_checkAllTilesTimer = rand() % 40;
+				_checkAllTilesTimer = FramesToTicks((float)(rand() % 40));
 			}
 			else
 			{
 				_checkAllTilesTimer--;
 			}
 			
-			if (System::FrameCountdown(_interactionTime, 20 + _checkAllTilesTimer))
+			if (System::FrameCountdown(_interactionTime, FramesToTicks(20) + _checkAllTilesTimer))
 			{
 				ClearObjective();
 				CheckAllTiles();
@@ -362,7 +362,11 @@ void Enemy::Update(float deltaTime)
 		}
 			break;
 		case MoveState::FINDING_PATH:
-			if (_objective != nullptr)
+			if (_pathRequest != -1)
+			{
+				ReceivePath();
+			}
+			else if (_objective != nullptr)
 			{
 				SetGoal(_objective);
 			}
@@ -391,7 +395,7 @@ void Enemy::Update(float deltaTime)
 		if (_visibilityTimer <= 0)
 		{
 			_visible = false;
-			_visibilityTimer = TIME_TO_HIDE;
+			_visibilityTimer = FramesToTicks(TIME_TO_HIDE);
 			if (_heldObject != nullptr)
 			{
 				_heldObject->SetVisibility(false);
@@ -403,7 +407,7 @@ void Enemy::Update(float deltaTime)
 void Enemy::ResetVisibilityTimer()
 {
 	_visible = true;
-	_visibilityTimer = TIME_TO_HIDE;
+	_visibilityTimer = FramesToTicks(TIME_TO_HIDE);
 	if (_heldObject != nullptr)
 	{
 		_heldObject->SetVisibility(true);
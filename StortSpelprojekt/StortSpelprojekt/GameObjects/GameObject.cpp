@@ -1,5 +1,7 @@
 #include "GameObject.h"
 
+float GameObject::_tickLength = FRAME_LENGTH;
+
 GameObject::GameObject(unsigned short ID, DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 rotation,  AI::Vec2D tilePosition, System::Type type, RenderObject * renderObject, System::SoundModule* soundModule, Renderer::ParticleEventQueue* particleEventQueue, DirectX::XMFLOAT3 colorOffset, int subType, AI::Vec2D direction)
 {
 	_ID = ID;
@@ -18,7 +20,8 @@ GameObject::GameObject(unsigned short ID, DirectX::XMFLOAT3 position, DirectX::X
 	_active = true;
 	_soundModule = soundModule;
 	_direction = direction;
-	CalculateMatrix();
+	_transformStore = nullptr;
+	_transformSlot = 0;
 	_animation = nullptr;
 	_particleEventQueue = particleEventQueue;
 }
@@ -30,13 +33,21 @@ GameObject::~GameObject()
 	{
 		delete _animation;
 	}
+	if (_transformStore != nullptr)
+	{
+		_transformStore->Remove(_transformSlot);
+	}
 }
 
-void GameObject::CalculateMatrix()
+/*
+Only marks the matrix as outdated, it is rebuilt by the TransformStore before it is rendered
+*/
+void GameObject::UpdateTransform()
 {
-	_objectMatrix = DirectX::XMMatrixScalingFromVector(DirectX::XMLoadFloat3(&_scale)) 
-			      * DirectX::XMMatrixRotationRollPitchYaw(_rotation.x, _rotation.y, _rotation.z) 
-		          * DirectX::XMMatrixTranslationFromVector(DirectX::XMLoadFloat3(&_position));
+	if (_transformStore != nullptr)
+	{
+		_transformStore->Set(_transformSlot, _position, _rotation, _scale);
+	}
 }
 
 unsigned short GameObject::GetID() const
@@ -46,7 +57,7 @@ unsigned short GameObject::GetID() const
 
 DirectX::XMMATRIX* GameObject::GetMatrix()
 {
-	return &_objectMatrix;
+	return _transformStore->GetMatrix(_transformSlot);
 }
 
 DirectX::XMFLOAT3 GameObject::GetPosition() const
@@ -67,19 +78,19 @@ DirectX::XMFLOAT3 GameObject::GetScale() const
 void GameObject::SetPosition(const DirectX::XMFLOAT3 & position)
 {
 	_position = position;
-	CalculateMatrix();
+	UpdateTransform();
 }
 
 void GameObject::SetRotation(const DirectX::XMFLOAT3 & rotation)
 {
 	_rotation = rotation;
-	CalculateMatrix();
+	UpdateTransform();
 }
 
 void GameObject::SetScale(const DirectX::XMFLOAT3 & scale)
 {
 	_scale = scale;
-	CalculateMatrix();
+	UpdateTransform();
 }
 
 void GameObject::Translate(const DirectX::XMFLOAT3 & offset)
@@ -87,7 +98,7 @@ void GameObject::Translate(const DirectX::XMFLOAT3 & offset)
 	_position.x += offset.x;
 	_position.y += offset.y;
 	_position.z += offset.z;
-	CalculateMatrix();
+	UpdateTransform();
 }
 
 void GameObject::Scale(const DirectX::XMFLOAT3& scale)
@@ -95,7 +106,7 @@ void GameObject::Scale(const DirectX::XMFLOAT3& scale)
 	_scale.x += scale.x;
 	_scale.y += scale.y;
 	_scale.z += scale.z;
-	CalculateMatrix();
+	UpdateTransform();
 }
 
 void GameObject::Rotate(const DirectX::XMFLOAT3& rotate)
@@ -103,7 +114,7 @@ void GameObject::Rotate(const DirectX::XMFLOAT3& rotate)
 	_rotation.x = rotate.x;
 	_rotation.y = rotate.y;
 	_rotation.z = rotate.z;
-	CalculateMatrix();
+	UpdateTransform();
 }
 AI::Vec2D GameObject::GetTilePosition() const
 {
@@ -213,6 +224,23 @@ PickUpState GameObject::GetPickUpState()const
 	return _pickUpState;
 }
 
+void GameObject::SetTickLength(float tickLength)
+{
+	_tickLength = tickLength;
+}
+
+/*
+At 60 ticks per second a tick is exactly one frame, so the counts are the same as before the tick rate could be set
+*/
+int GameObject::FramesToTicks(float frames)
+{
+	if (frames <= 0.0f)
+	{
+		return (int)frames;
+	}
+	return max(1, (int)(frames * FRAME_LENGTH / _tickLength + 0.5f));
+}
+
 DirectX::XMFLOAT3 GameObject::GetColorOffset() const
 {
 	return _colorOffset;
@@ -223,6 +251,19 @@ void GameObject::SetColorOffset(const DirectX::XMFLOAT3& colorOffset)
 	_colorOffset = colorOffset;
 }
 
+void GameObject::SetTransformStore(TransformStore* transformStore)
+{
+	if (_transformStore != nullptr)
+	{
+		_transformStore->Remove(_transformSlot);
+	}
+	_transformStore = transformStore;
+	if (_transformStore != nullptr)
+	{
+		_transformSlot = _transformStore->Add(_position, _rotation, _scale);
+	}
+}
+
 void GameObject::AddColorOffset(const DirectX::XMFLOAT3& colorOffset)
 {
 	_colorOffset.x += colorOffset.x;
@@ -232,12 +273,12 @@ void GameObject::AddColorOffset(const DirectX::XMFLOAT3& colorOffset)
 
 void* GameObject::operator new(size_t i)
 {
-	return _mm_malloc(i, 16);
+	return ObjectPool::AllocateShared(i);
 }
 
-void GameObject::operator delete(void* p)
+void GameObject::operator delete(void* p, size_t i)
 {
-	_mm_free(p);
+	ObjectPool::FreeShared(p, i);
 }
 
 bool GameObject::operator<(const GameObject& other)
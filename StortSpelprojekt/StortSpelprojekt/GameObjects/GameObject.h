@@ -4,8 +4,10 @@
 #include "CommonUtils.h"
 #include "AIUtil.h"
 #include "Animation.h"
-#include "ParticleSystem\ParticleEventQueue.h"
+#include "ParticleSystem/ParticleEventQueue.h"
 #include "../System/SoundModule.h"
+#include "../TransformStore.h"
+#include "../ObjectPool.h"
 
 /*
 GameObject class
@@ -14,16 +16,23 @@ Base interface for specialized GameObjects.
 Contains an unique ID for identification, a world position and a enum Type
 If the object doesn't need a _renderObject, set it to nullptr.
 If the object has a renderObject but is out of sight _visibility will be false.
+The world matrix is kept in the TransformStore of the ObjectHandler, which the object gets when it is added.
+
+Update is called once per game logic tick. Times in the game logic, like animation lengths, blueprint timers and
+move speeds, are given in frames of FRAME_LENGTH ms, the tick length of the game before the tick rate could be set.
+They are converted to ticks of the current length with FramesToTicks, so the game runs at the same speed at any rate.
 */
 
 enum PickUpState{ONTILE, HELD, PICKINGUP, PICKEDUP, DROPPING};
 const float TILE_EPSILON = 0.05f;			//Maximum offset for a position to be considered centered on a tile
+const float FRAME_LENGTH = 1000.0f / 60.0f;	//Length in ms of the frames game logic times are given in
 class GameObject
 {
 protected:
 
 	unsigned short _ID;
-	DirectX::XMMATRIX _objectMatrix;
+	TransformStore* _transformStore;
+	unsigned int _transformSlot;
 	DirectX::XMFLOAT3 _position;
 	DirectX::XMFLOAT3 _rotation;
 	DirectX::XMFLOAT3 _scale;
@@ -43,7 +52,10 @@ protected:
 
 	PickUpState _pickUpState;
 	bool _isTargeted;
-	void CalculateMatrix();
+	void UpdateTransform();			//Must be called after changing _position, _rotation or _scale
+
+	static float _tickLength;			//Length in ms of a game logic tick, the same for all objects
+	static int FramesToTicks(float frames);	//Rounded to whole ticks, at least one if frames is positive
 
 public:
 	//Type might not be necessary, depending on whether subclasses can correspond to one type or many.
@@ -55,13 +67,14 @@ public:
 	DirectX::XMFLOAT3 GetPosition() const;
 	DirectX::XMFLOAT3 GetRotation() const;
 	DirectX::XMFLOAT3 GetScale() const;
-	DirectX::XMMATRIX* GetMatrix();
+	DirectX::XMMATRIX* GetMatrix();						//Only valid until the next object is added
 	DirectX::XMFLOAT3 GetColorOffset() const;
 
 	void SetPosition(const DirectX::XMFLOAT3& position);
 	void SetRotation(const DirectX::XMFLOAT3& rotation);
 	void SetScale(const DirectX::XMFLOAT3& scale);
 	void SetColorOffset(const DirectX::XMFLOAT3& colorOffset);
+	void SetTransformStore(TransformStore* transformStore);
 
 	void AddColorOffset(const DirectX::XMFLOAT3& colorOffset);
 
@@ -96,12 +109,13 @@ public:
 
 	//Update object gamelogic
 	void virtual Update(float deltaTime) = 0;
+	static void SetTickLength(float tickLength);		//Set by ObjectHandler, in ms
 
 	void virtual Release() = 0;
 
-	//Overloading these guarantees 16B alignment of XMMATRIX
+	//Game objects are taken from the shared object pools, one per size, which also keeps them 16B aligned
 	void* operator new(size_t i);
-	void operator delete(void* p);
+	void operator delete(void* p, size_t i);
 
 	bool operator<(const GameObject& other);
 	// Returns 0 if _animation = nullptr
@@ -133,7 +133,7 @@ void Guard::Wait()
 		CheckVisibleTiles();
 		if (_moveState == MoveState::IDLE)
 		{
-			_waiting = 30;			//Arbitrary number. Just pick something you like
+			_waiting = FramesToTicks(30);			//Arbitrary number. Just pick something you like
 		}
 	}
 }
@@ -154,7 +154,11 @@ void Guard::Update(float deltaTime)
 			Wait();
 			break;
 		case MoveState::FINDING_PATH:
-			if (_objective != nullptr)
+			if (_pathRequest != -1)
+			{
+				ReceivePath();
+			}
+			else if (_objective != nullptr)
 			{
 				SetGoal(_objective);
 			}
@@ -204,7 +208,7 @@ void Guard::Act(GameObject* obj)
 			if (!static_cast<Trap*>(obj)->IsTrapActive())
 			{
 				Animate(FIXTRAPANIM);
-				if(System::FrameCountdown(_interactionTime, (int)_animation->GetLength(FIXTRAPANIM)))
+				if(System::FrameCountdown(_interactionTime, FramesToTicks(_animation->GetLength(FIXTRAPANIM))))
 				{
 					static_cast<Trap*>(obj)->SetTrapActive(true);
 					ClearObjective();
@@ -213,7 +217,7 @@ void Guard::Act(GameObject* obj)
 			break;
 		case  System::ENEMY:											//The guard hits the enemy
 			Animate(FIGHTANIM);
-			if(System::FrameCountdown(_interactionTime, (int)_animation->GetLength(FIGHTANIM)))
+			if(System::FrameCountdown(_interactionTime, FramesToTicks(_animation->GetLength(FIGHTANIM))))
 			{
 				Unit* enemy = static_cast<Unit*>(obj);
 				enemy->TakeDamage(_baseDamage);
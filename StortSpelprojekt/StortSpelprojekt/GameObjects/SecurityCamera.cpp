@@ -16,10 +16,10 @@ void SecurityCamera::Rotate()
 		{
 			_rotation.y = 3 * DirectX::XM_PIDIV2 - DirectX::XM_PIDIV4 * _direction._y;
 		}
-		CalculateMatrix();
+		UpdateTransform();
 	}
 	//_visionCone->ColorVisibleTiles({0,0,0});
-	_visionCone->FindVisibleTiles(_tilePosition, _direction);
+	_visionCone->RequestUpdate(_tilePosition, _direction);
 	//_visionCone->ColorVisibleTiles({0,0,3});
 	CheckVisibleTiles();
 }
@@ -30,7 +30,6 @@ SecurityCamera::SecurityCamera(unsigned short ID, DirectX::XMFLOAT3 position, Di
 	_tileMap = tileMap;
 	_visionRadius = 7;
 	_visionCone = new VisionCone(_visionRadius, _tileMap);
-	_visionCone->FindVisibleTiles(_tilePosition, _direction);
 	_subType = 0;
 	Rotate();
 }
@@ -49,13 +48,14 @@ AI::Vec2D SecurityCamera::GetDirection() const
 void SecurityCamera::SetDirection(AI::Vec2D direction)
 {
 	_direction = direction;
-	_visionCone->FindVisibleTiles(_tilePosition, _direction);
+	_visionCone->RequestUpdate(_tilePosition, _direction);
 	ShowAreaOfEffect();
 }
 
 void SecurityCamera::CheckVisibleTiles()
 {
 	Enemy* test = nullptr;
+	_visionCone->Update();
 	//_visionCone->ColorVisibleTiles({0,0,3});
 	AI::Vec2D tile = {0,0};
 	for (int i = 0; i < _visionCone->GetNrOfVisibleTiles(); i++)
@@ -73,10 +73,11 @@ void SecurityCamera::CheckVisibleTiles()
 	}
 }
 
+/*
+	Enemies in view are kept visible by ObjectHandler through the guards' team in the VisibilityGrid
+*/
 void SecurityCamera::Update(float deltaTime)
-{
-	CheckVisibleTiles();
-}
+{}
 
 void SecurityCamera::Release()
 {}
@@ -84,7 +85,7 @@ void SecurityCamera::Release()
 void SecurityCamera::SetTilePosition(AI::Vec2D pos)
 {
 	GameObject::SetTilePosition(pos);
-	_visionCone->FindVisibleTiles(_tilePosition, _direction);
+	_visionCone->RequestUpdate(_tilePosition, _direction);
 	ShowAreaOfEffect();
 }
 
@@ -93,6 +94,11 @@ int SecurityCamera::GetVisionRadius() const
 	return _visionRadius;
 }
 
+VisionCone* SecurityCamera::GetVisionCone() const
+{
+	return _visionCone;
+}
+
 //Info colors
 void SecurityCamera::ShowAreaOfEffect()
 {
@@ -104,6 +110,7 @@ void SecurityCamera::ShowAreaOfEffect()
 
 	GameObject::ShowAreaOfEffect();
 
+	_visionCone->Update();
 	for (int i = 0; i < _visionCone->GetNrOfVisibleTiles(); i++)
 	{
 		AI::Vec2D tile = _visionCone->GetVisibleTiles()[i];
@@ -22,6 +22,7 @@ public:
 	void Release();
 	void SetTilePosition(AI::Vec2D pos);
 	int GetVisionRadius()const;
+	VisionCone* GetVisionCone()const;
 
 	//// Overloaded because of visibility
 	void ShowAreaOfEffect();
@@ -590,7 +590,7 @@ void Trap::Activate()
 	}
 	else
 	{
-		_triggerTimer = _maxTimeToTrigger;
+		_triggerTimer = FramesToTicks((float)_maxTimeToTrigger);
 	}
 }
 
@@ -605,7 +605,7 @@ void Trap::Update(float deltaTime)
 
 	if (_subType == TrapType::SAW )
 	{
-		if (System::FrameCountdown(_triggerTimer, _maxTimeToTrigger, 0))
+		if (System::FrameCountdown(_triggerTimer, FramesToTicks((float)_maxTimeToTrigger), 0))
 		{
 
 			int i = 0;
@@ -1,7 +1,7 @@
 #pragma once
 #include "GameObject.h"
 #include "Unit.h"
-#include "ParticleSystem\ParticleEventQueue.h"
+#include "ParticleSystem/ParticleEventQueue.h"
 #include <memory>
 
 enum TrapType{ ANVIL, TESLACOIL, SHARK, GUN, SAW, CAKEBOMB, BEAR, FLAMETHROWER, WATER_GUN, SPIN_TRAP};
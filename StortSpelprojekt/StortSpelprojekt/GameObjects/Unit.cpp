@@ -1,19 +1,151 @@
 #include "Unit.h"
 
+/*
+Loot and spawn points are shared goals, units heading there follow a flow field.
+Other long trips are first planned on the hierarchical pathfinding of the tilemap, then refined a few waypoints at a time.
+Units with tile costs of their own replan over and over as they spot traps, their paths are repaired by their own planner.
+Other short trips, and trips the hierarchical pathfinding can't find, are requested from the pathfinding worker threads.
+The unit then stays in FINDING_PATH until the path is received.
+*/
 void Unit::CalculatePath()
 {
-	if (_aStar->FindPath())
+	AI::PathfindingService* pathfinding = _tileMap->GetPathfinding();
+	_waypoints.clear();
+	_followsFlowField = false;
+	if (_pathRequest != -1)											//The goal changed before the previous path arrived
+	{
+		pathfinding->CancelPathRequest(_pathRequest);
+		_pathRequest = -1;
+	}
+	if (_objective != nullptr && (_objective->GetType() == System::LOOT || _objective->GetType() == System::SPAWN) && !HasOwnTileCosts())
+	{
+		AI::FlowField* flowField = pathfinding->GetFlowField(_goalTilePosition, &_costOverrides);
+		if (flowField->IsReachable(_nextTile))
+		{
+			_followsFlowField = true;
+			_pathLength = flowField->GetNrOfSteps(_nextTile);
+		}
+		else
+		{
+			ClearObjective();
+		}
+	}
+	else if (GetApproxDistance(_goalTilePosition) > 2 * pathfinding->GetClusterSize() && pathfinding->FindWaypoints(_nextTile, _goalTilePosition, _waypoints))
 	{
-		_path = _aStar->GetPath();
-		_pathLength = _aStar->GetPathLength();
+		if (!RefinePath())
+		{
+			ClearObjective();
+		}
+	}
+	else if (HasOwnTileCosts())
+	{
+		if (!Replan())
+		{
+			ClearObjective();
+		}
 	}
 	else
 	{
-		ClearObjective();
+		_pathRequest = pathfinding->RequestPath(_nextTile, _goalTilePosition, &_costOverrides);
+		_moveState = MoveState::FINDING_PATH;
+		return;
 	}
 	_moveState = MoveState::MOVING;
 }
 
+void Unit::ReceivePath()
+{
+	bool found = false;
+	if (_tileMap->GetPathfinding()->GetPathResult(_pathRequest, found, _path))
+	{
+		_pathRequest = -1;
+		if (found)
+		{
+			_pathLength = (int)_path.size();
+		}
+		else
+		{
+			ClearObjective();
+		}
+		_moveState = MoveState::MOVING;
+	}
+}
+
+/*
+Finds the path from _nextTile with _planner. The planner is only created once it is needed and is then kept up to date with
+the tiles that changed cost since the last time, so replanning towards the same goal only repairs what those changes affected.
+*/
+bool Unit::Replan()
+{
+	AI::PathfindingService* pathfinding = _tileMap->GetPathfinding();
+	std::vector<AI::Vec2D> changedTiles;
+	if (_planner != nullptr && !pathfinding->GetChangedTiles(_plannerCostVersion, changedTiles))
+	{
+		pathfinding->ReleasePlanner(_planner);
+		_planner = nullptr;
+	}
+	if (_planner == nullptr)
+	{
+		_planner = pathfinding->CreatePlanner();
+		for (unsigned int i = 0; i < _costOverrides.size(); i++)
+		{
+			_planner->SetTileCost(_costOverrides[i]._position, _costOverrides[i]._cost);
+		}
+		_planner->Init(_nextTile, _goalTilePosition);
+	}
+	else
+	{
+		for (unsigned int i = 0; i < changedTiles.size(); i++)
+		{
+			_planner->SetTileCost(changedTiles[i], GetTileCost(changedTiles[i]));
+		}
+		if (_planner->GetGoal() != _goalTilePosition)
+		{
+			_planner->Init(_nextTile, _goalTilePosition);
+		}
+		else
+		{
+			_planner->SetStartPosition(_nextTile);
+		}
+	}
+	_plannerCostVersion = pathfinding->GetCostVersion();
+	if (!_planner->FindPath())
+	{
+		_pathLength = 0;
+		return false;
+	}
+	_path.assign(_planner->GetPath(), _planner->GetPath() + _planner->GetPathLength());
+	_pathLength = (int)_path.size();
+	return true;
+}
+
+/*
+Finds the tiles from _nextTile to the waypoint WAYPOINT_LOOKAHEAD steps ahead, using the unit's own tile costs.
+If that fails, e.g. because of costs only this unit knows about, the rest of the trip is planned in one go.
+*/
+bool Unit::RefinePath()
+{
+	if (_waypoints.empty())
+	{
+		return false;
+	}
+	int nrOfPlanned = (int)_waypoints.size() < WAYPOINT_LOOKAHEAD ? (int)_waypoints.size() : WAYPOINT_LOOKAHEAD;
+	AI::Vec2D target = _waypoints[_waypoints.size() - nrOfPlanned];
+	_waypoints.resize(_waypoints.size() - nrOfPlanned);
+	AI::PathfindingService* pathfinding = _tileMap->GetPathfinding();
+	if (!pathfinding->FindPath(_nextTile, target, _path, &_costOverrides))
+	{
+		_waypoints.clear();
+		if (!pathfinding->FindPath(_nextTile, _goalTilePosition, _path, &_costOverrides))
+		{
+			_pathLength = 0;
+			return false;
+		}
+	}
+	_pathLength = (int)_path.size();
+	return true;
+}
+
 void Unit::Rotate()
 {
 	if (_direction._x != 0 || _direction._y != 0)
@@ -30,14 +162,88 @@ void Unit::Rotate()
 		{
 			_rotation.y = 3 * DirectX::XM_PIDIV2 - DirectX::XM_PIDIV4 * _direction._y;
 		}
-		CalculateMatrix();
+		UpdateTransform();
+	}
+	_visionCone->RequestUpdate(_tilePosition, _direction);
+}
+
+/*
+Follows the flow field, the path, or plans the next part of a hierarchical path.
+The flow field is asked for every tile, so that it is rebuilt if the map changes.
+*/
+bool Unit::FindNextTile()
+{
+	if (_followsFlowField)
+	{
+		AI::FlowField* flowField = _tileMap->GetPathfinding()->GetFlowField(_goalTilePosition, &_costOverrides);
+		if (!flowField->IsReachable(_tilePosition) || flowField->GetNrOfSteps(_tilePosition) == 0)
+		{
+			return false;
+		}
+		_nextTile = flowField->GetNextTile(_tilePosition);
+		_pathLength = flowField->GetNrOfSteps(_nextTile);
+		return true;
+	}
+	if (_pathLength > 0 /*&& !_tileMap->IsGuardOnTile(_path[_pathLength - 1])*/ || RefinePath())		//Refines the next part when a waypoint is reached
+	{
+		_nextTile = _path[--_pathLength];
+		return true;
+	}
+	return false;
+}
+
+/*
+The costs of loot on furniture are the same for every enemy, so those share a flow field built with them.
+Any other cost of the unit would give it a field of its own, so it plans with A* instead
+*/
+bool Unit::HasOwnTileCosts() const
+{
+	for (unsigned int i = 0; i < _costOverrides.size(); i++)
+	{
+		if (!_tileMap->IsFurnitureOnTile(_costOverrides[i]._position))
+		{
+			return true;
+		}
 	}
-	_visionCone->FindVisibleTiles(_tilePosition, _direction);
+	return false;
 }
 
 int Unit::GetApproxDistance(AI::Vec2D target) const
 {
-	return (int)_aStar->GetHeuristicDistance(_tilePosition, target);
+	return (int)AI::GetOctileDistance(_tilePosition, target);
+}
+
+int Unit::GetTileCost(AI::Vec2D pos) const
+{
+	for (unsigned int i = 0; i < _costOverrides.size(); i++)
+	{
+		if (_costOverrides[i]._position == pos)
+		{
+			return _costOverrides[i]._cost;
+		}
+	}
+	return _tileMap->GetPathfinding()->GetTileCost(pos);
+}
+
+void Unit::SetTileCost(AI::Vec2D pos, int cost)
+{
+	unsigned int i = 0;
+	while (i < _costOverrides.size() && _costOverrides[i]._position != pos)
+	{
+		i++;
+	}
+	if (i < _costOverrides.size())
+	{
+		_costOverrides[i]._cost = cost;
+	}
+	else
+	{
+		_costOverrides.push_back(AI::CostOverride(pos, cost));
+	}
+	if (_planner != nullptr)
+	{
+		_planner->SetTileCost(pos, cost);
+	}
 }
 
 /*
@@ -62,15 +268,18 @@ void Unit::SetGoal(AI::Vec2D goal)
 void Unit::ExpandArray(GameObject** &arr, int &sizeOfArray)
 {
 	int increment = 5;
-	GameObject** temp = new GameObject*[sizeOfArray + increment];
+	GameObject** temp = (GameObject**)ObjectPool::AllocateShared(sizeof(GameObject*) * (sizeOfArray + increment));
 
 	for (int i = 0; i < sizeOfArray; i++)
 	{
 		temp[i] = arr[i];
 	}
 
+	if (arr != nullptr)
+	{
+		ObjectPool::FreeShared(arr, sizeof(GameObject*) * sizeOfArray);
+	}
 	sizeOfArray += increment;
-	delete[] arr;
 	arr = temp;
 }
 
@@ -79,9 +288,6 @@ void Unit::SetGoal(GameObject * objective)
 
 	_goalTilePosition = objective->GetTilePosition();
 	_objective = objective;
-	_aStar->CleanMap();
-	_aStar->SetStartPosition(_nextTile);
-	_aStar->SetGoalPosition(_goalTilePosition);
 	CalculatePath();
 }
 
@@ -93,14 +299,17 @@ Unit::Unit(unsigned short ID, DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 rota
 	_goalTilePosition = _tilePosition;
 	_tileMap = tileMap;
 	_visionCone = new VisionCone(_visionRadius, _tileMap);
-	_aStar = new AI::AStar(_tileMap->GetWidth(), _tileMap->GetHeight(), _tilePosition, { 0,0 }, AI::AStar::OCTILE);
 	_heldObject = nullptr;
 	_objective = nullptr;
 	_waiting = -1;
 	_pathLength = 0;
-	_path = nullptr;
+	_followsFlowField = false;
+	_pathRequest = -1;
+	_planner = nullptr;
+	_plannerCostVersion = 0;
 	_nextTile = _tilePosition;
 	_isSwitchingTile = false;
+	_hasPendingVisionCheck = false;
 	Rotate();
 	if (_renderObject->_mesh->_isSkinned)
 	{
@@ -114,19 +323,36 @@ Unit::Unit(unsigned short ID, DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 rota
 	_statusTimer = 0;
 	_statusInterval = 0;
 	_allLoot = nullptr;
+	_nrOfLoot = 0;
+	_lootCapacity = 0;
 	_allSpawnPoints = nullptr;
+	_nrOfSpawnPoints = 0;
+	_spawnPointCapacity = 0;
 
 }
 
 Unit::~Unit()
 {
-	delete _aStar;
+	if (_pathRequest != -1)											//Stops the search, or drops its result if it is done
+	{
+		_tileMap->GetPathfinding()->CancelPathRequest(_pathRequest);
+	}
 	HideAreaOfEffect();
 	_particleEventQueue->Insert(new ParticleUpdateMessage(_ID, false));
 
 	delete _visionCone;
-	delete[] _allSpawnPoints;
-	delete[] _allLoot;
+	if (_planner != nullptr)
+	{
+		_tileMap->GetPathfinding()->ReleasePlanner(_planner);
+	}
+	if (_allSpawnPoints != nullptr)
+	{
+		ObjectPool::FreeShared(_allSpawnPoints, sizeof(GameObject*) * _spawnPointCapacity);
+	}
+	if (_allLoot != nullptr)
+	{
+		ObjectPool::FreeShared(_allLoot, sizeof(GameObject*) * _lootCapacity);
+	}
 }
 
 int Unit::GetPathLength() const
@@ -215,14 +441,14 @@ void Unit::SetVisibility(bool visible)
 void Unit::SetPosition(const DirectX::XMFLOAT3& position)
 {
 	_position = position;
-	CalculateMatrix();
+	UpdateTransform();
 
 }
 
 void Unit::SetTilePosition(AI::Vec2D pos)
 {
 	GameObject::SetTilePosition(pos);
-	_visionCone->FindVisibleTiles(_tilePosition, _direction);
+	_visionCone->RequestUpdate(_tilePosition, _direction);
 	if (_moveState == MoveState::IDLE)
 	{
 		_nextTile = pos;
@@ -235,12 +461,12 @@ void Unit::SetStatusEffect(StatusEffect effect, int intervalTime, int totalTime)
 	if (_status != effect)
 	{
 		_status = effect;
-		_statusInterval = intervalTime;
-		_statusTimer = totalTime;
+		_statusInterval = FramesToTicks((float)intervalTime);
+		_statusTimer = FramesToTicks((float)totalTime);
 	}
 	else if (_status == effect)
 	{
-		_statusTimer = totalTime;
+		_statusTimer = FramesToTicks((float)totalTime);
 		_statusTimer--;
 	}
 	
@@ -251,8 +477,20 @@ bool Unit::IsSwitchingTile() const
 	return _isSwitchingTile;
 }
 
+bool Unit::HasPendingVisionCheck() const
+{
+	return _hasPendingVisionCheck;
+}
+
+VisionCone* Unit::GetVisionCone() const
+{
+	return _visionCone;
+}
+
 void Unit::CheckVisibleTiles()
 {
+	_hasPendingVisionCheck = false;
+	_visionCone->Update();
 	AI::Vec2D* visibleTiles = _visionCone->GetVisibleTiles();
 
 	for (int i = 0; i < _visionCone->GetNrOfVisibleTiles(); i++)
@@ -309,18 +547,26 @@ void Unit::CheckAllTiles()
 
 void Unit::InitializePathFinding()
 {
-	int lootCounter = 10/*_tileMap->GetNrOfLoot()*/;
+	//Kept if the unit is initialized again, the arrays are only ever grown
+	if (_allLoot == nullptr)
+	{
+		_lootCapacity = 10/*_tileMap->GetNrOfLoot()*/;
+		_allLoot = (GameObject**)ObjectPool::AllocateShared(sizeof(GameObject*) * _lootCapacity);
+	}
 	_nrOfLoot = 0;
-	_allLoot = new GameObject*[lootCounter];
-	int spawnPointCounter = 10;
+	if (_allSpawnPoints == nullptr)
+	{
+		_spawnPointCapacity = 10;
+		_allSpawnPoints = (GameObject**)ObjectPool::AllocateShared(sizeof(GameObject*) * _spawnPointCapacity);
+	}
 	_nrOfSpawnPoints = 0;
-	_allSpawnPoints = new GameObject*[spawnPointCounter];
+	_costOverrides.clear();
 
-	for (int i = 0; i < lootCounter; i++)
+	for (int i = 0; i < _lootCapacity; i++)
 	{
 		_allLoot[i] = nullptr;
 	}
-	for (int i = 0; i < spawnPointCounter; i++)
+	for (int i = 0; i < _spawnPointCapacity; i++)
 	{
 		_allSpawnPoints[i] = nullptr;
 	}
@@ -329,42 +575,26 @@ void Unit::InitializePathFinding()
 	{
 		for (int j = 0; j < _tileMap->GetHeight(); j++)
 		{
-			//Handle walls
-			if (_tileMap->IsWallOnTile(AI::Vec2D(i, j)))
-			{
-				_aStar->SetTileCost({i, j}, -1);
-			}
-			else if (_tileMap->IsFurnitureOnTile(AI::Vec2D(i, j)))
-			{
-				//Make an exception for enemies trying to reach loot
-				if (_type == System::ENEMY && _tileMap->IsObjectiveOnTile(i,j))			
-				{
-					_aStar->SetTileCost({ i, j }, 20);
-				}
-				else
-				{
-					_aStar->SetTileCost({ i, j }, -1);
-				}
-			}
-			else
+			//Walls and furniture are handled by the shared pathfinding. Make an exception for enemies trying to reach loot
+			if (_type == System::ENEMY && _tileMap->IsFurnitureOnTile(AI::Vec2D(i, j)) && _tileMap->IsObjectiveOnTile(i, j))
 			{
-				_aStar->SetTileCost({i, j}, 1);
+				SetTileCost({ i, j }, 20);
 			}
 
 			//Used for Enemy AI for faster scan of objectives
 			if (_tileMap->IsObjectiveOnTile(i, j))
 			{
-				if (_nrOfLoot >= lootCounter)
+				if (_nrOfLoot >= _lootCapacity)
 				{
-					ExpandArray(_allLoot, lootCounter);
+					ExpandArray(_allLoot, _lootCapacity);
 				}
 				_allLoot[_nrOfLoot++] = _tileMap->GetObjectOnTile({ i, j }, System::LOOT);
 			}
 			else if (_tileMap->IsSpawnOnTile(i, j))
 			{
-				while (_nrOfSpawnPoints >= spawnPointCounter)
+				while (_nrOfSpawnPoints >= _spawnPointCapacity)
 				{
-					ExpandArray(_allSpawnPoints, spawnPointCounter);
+					ExpandArray(_allSpawnPoints, _spawnPointCapacity);
 				}
 				_allSpawnPoints[_nrOfSpawnPoints++] = _tileMap->GetObjectOnTile({ i, j }, System::SPAWN);
 			}
@@ -425,20 +655,26 @@ void Unit::Moving()
 	}
 	else
 	{
-		if (_direction._x == 0 || _direction._y == 0)		//Right angle movement
+		//_moveSpeed is per frame. The step stops at the tile, so a long tick can not skip past it
+		float step = _moveSpeed * _tickLength / FRAME_LENGTH;
+		if (_direction._x != 0 && _direction._y != 0)		//Diagonal movement
 		{
-			_position.x += _moveSpeed * _direction._x;
-			_position.z += _moveSpeed * _direction._y;
+			step *= AI::SQRT2 * 0.5f;
 		}
-		else												//Diagonal movement
+		if (step >= max(abs(_nextTile._x - _position.x), abs(_nextTile._y - _position.z)))
 		{
-			_position.x += AI::SQRT2 * 0.5f * _moveSpeed * _direction._x;
-			_position.z += AI::SQRT2 * 0.5f * _moveSpeed * _direction._y;
+			_position.x = (float)_nextTile._x;
+			_position.z = (float)_nextTile._y;
+		}
+		else
+		{
+			_position.x += step * _direction._x;
+			_position.z += step * _direction._y;
 		}
 
 
 
-		CalculateMatrix();
+		UpdateTransform();
 	}
 }
 
@@ -468,9 +704,8 @@ void Unit::SwitchingNode()
 			{
 				_moveState = MoveState::AT_OBJECTIVE;
 			}
-			else if (_pathLength > 0 /*&& !_tileMap->IsGuardOnTile(_path[_pathLength - 1])*/)
+			else if (FindNextTile())
 			{
-				_nextTile = _path[--_pathLength];
 				_direction = _nextTile - _tilePosition;
 				Rotate();
 				_moveState = MoveState::MOVING;
@@ -481,7 +716,7 @@ void Unit::SwitchingNode()
 				_moveState = MoveState::IDLE;
 			}
 			_isSwitchingTile = false;
-			CheckVisibleTiles();
+			_hasPendingVisionCheck = true;				//Done by ObjectHandler once every cone has been updated
 		}
 		else
 		{
@@ -494,8 +729,15 @@ void Unit::SwitchingNode()
 void Unit::ClearObjective()
 {
 	_objective = nullptr;
-	_path = nullptr;
+	_path.clear();
 	_pathLength = 0;
+	_waypoints.clear();
+	_followsFlowField = false;
+	if (_pathRequest != -1)
+	{
+		_tileMap->GetPathfinding()->CancelPathRequest(_pathRequest);
+		_pathRequest = -1;
+	}
 }
 
 void Unit::Release()
@@ -638,6 +880,7 @@ void Unit::ShowAreaOfEffect()
 
 	GameObject::ShowAreaOfEffect();
 
+	_visionCone->Update();
 	for (int i = 0; i < _visionCone->GetNrOfVisibleTiles(); i++)
 	{
 		AI::Vec2D tile = _visionCone->GetVisibleTiles()[i];
@@ -1,7 +1,7 @@
 #pragma once
 #include "GameObject.h"
 #include "../Tilemap.h"
-#include "AStar.h"
+#include "PathfindingService.h"
 #include "../VisionCone.h"
 #include <DirectXMath.h>
 #include <stdlib.h>
@@ -16,14 +16,22 @@ protected:
 	//Pathfinding variables
 	AI::Vec2D _nextTile;			//The tile it is currently walking to.
 	AI::Vec2D _goalTilePosition;	//The tile it eventually wants to reach.
-	AI::AStar* _aStar;
-	AI::Vec2D* _path;
-	int _pathLength;
+	std::vector<AI::Vec2D> _path;		//Ordered from goal to start
+	int _pathLength;				//Number of tiles left to walk in _path
+	std::vector<AI::Vec2D> _waypoints;	//What remains of a hierarchical path, ordered from goal to start
+	static const int WAYPOINT_LOOKAHEAD = 3;	//Number of waypoints planned at a time. Planning past the closest one smooths the path at cluster borders
+	std::vector<AI::CostOverride> _costOverrides;	//Tile costs only this unit uses, replacing those of the shared pathfinding
+	bool _followsFlowField;			//Walks along the flow field shared by units with the same _costOverrides instead of _path
+	int _pathRequest;				//Id of the asynchronous path request being waited for in FINDING_PATH, -1 if none
+	AI::DStarLite* _planner;		//Incremental planner of a unit with its own tile costs, nullptr until it first replans
+	unsigned int _plannerCostVersion;	//Cost version of the shared pathfinding the planner is up to date with
 	const Tilemap* _tileMap;		//Pointer to the tileMap in objectHandler(?). Units should preferably have read-, but not write-access.
-	GameObject** _allLoot;
+	GameObject** _allLoot;			//Taken from the shared object pools, like the units themselves
 	int _nrOfLoot;
+	int _lootCapacity;
 	GameObject** _allSpawnPoints;
 	int _nrOfSpawnPoints;
+	int _spawnPointCapacity;
 	GameObject* _objective;
 	GameObject* _heldObject;
 	int _goalPriority;				//Lower value means higher priority
@@ -45,6 +53,7 @@ protected:
 	//Movement state variables
 	MoveState _moveState;
 	bool _isSwitchingTile;			//Indicator to ObjectHandler that it should be moved to a different tile
+	bool _hasPendingVisionCheck;	//Indicator to ObjectHandler that it should call CheckVisibleTiles once the vision cones are updated
 	int _interactionTime;			//Timer for when it needs to do something.
 	int _waiting;
 
@@ -52,13 +61,19 @@ protected:
 	Anim _lastAnimState;
 
 	void CalculatePath();								//Calls pathfiding algorithm and checks that a path was indeed found
+	bool RefinePath();									//Plans the tiles to the next waypoints of a hierarchical path
+	void ReceivePath();									//Picks up the result of _pathRequest once it is done
+	bool Replan();										//Finds the path with _planner, repairing the previous one
+	bool FindNextTile();								//Sets _nextTile to the next tile of the path. Returns false if there is none
+	bool HasOwnTileCosts()const;						//True if the unit has tile costs a shared flow field doesn't know of
 	void Rotate();										//Rotation for model, game logic and vision cone
 	int GetApproxDistance(AI::Vec2D target)const;		//The distance to a position assuming no obstacles. Used for picking a target.
 	void SetGoal(AI::Vec2D goal);
 	void SetGoal(GameObject* objective);				//Does the things necessary to change the pathfinding to a new goal
 	void ExpandArray(GameObject** &arr, int &sizeOfArray);
+	int GetTileCost(AI::Vec2D pos)const;				//Cost of the tile as seen by this unit
+	void SetTileCost(AI::Vec2D pos, int cost);			//Overrides the shared cost of the tile for this unit only
 
-	void CheckVisibleTiles();																	//Checks for targets in vision cone. Typically done after switching tile.
 	virtual void Moving();											//Update function when unit is not dead center on a tile.
 	virtual void SwitchingNode();									//Update function when unit is on a tile center and needs to decide next tile to move to.
 	virtual void EvaluateTile(System::Type objective, AI::Vec2D tile) = 0;
@@ -89,8 +104,11 @@ public:
 	void SetStatusEffect(StatusEffect effect, int intervalTime = 0, int totalTime = 0);			//set type of effect, duration of effect, and time between each activation
 
 	bool IsSwitchingTile()const;
+	bool HasPendingVisionCheck()const;
+	VisionCone* GetVisionCone()const;
 
 	//Decision making
+	void CheckVisibleTiles();																	//Checks for targets in vision cone. Typically done after switching tile.
 																	//Checks the whole map. Typically done by idle enemies to find loot or an exit point.
 	void InitializePathFinding();																//Transfers map info to the pathfinding. Done once the tilemap is fully loaded.
 	void CheckAllTiles();
@@ -0,0 +1,88 @@
+#include "InstanceBatcher.h"
+
+InstanceBatcher::InstanceBatcher()
+{
+	_instances = nullptr;
+	_capacity = 0;
+}
+
+InstanceBatcher::~InstanceBatcher()
+{
+	if (_instances != nullptr)
+	{
+		_mm_free(_instances);
+	}
+}
+
+bool InstanceBatcher::IsBatchedBefore(const Entry& first, const Entry& second)
+{
+	return first._renderObject < second._renderObject;
+}
+
+void InstanceBatcher::Clear()
+{
+	_entries.clear();
+	_batches.clear();
+}
+
+void InstanceBatcher::Add(RenderObject* renderObject, const DirectX::XMMATRIX* world, DirectX::XMFLOAT3 colorOffset)
+{
+	Entry entry;
+	entry._renderObject = renderObject;
+	entry._world = world;
+	entry._colorOffset = colorOffset;
+	_entries.push_back(entry);
+}
+
+void InstanceBatcher::Build()
+{
+	_batches.clear();
+	if (_entries.size() > _capacity)
+	{
+		if (_instances != nullptr)
+		{
+			_mm_free(_instances);
+		}
+		_capacity = max(256u, _capacity);
+		while (_capacity < _entries.size())
+		{
+			_capacity *= 2;
+		}
+		_instances = (InstanceData*)_mm_malloc(_capacity * sizeof(InstanceData), 16);
+	}
+
+	//The culled objects are already sorted by render object within every type, so this is mostly merging the types
+	std::stable_sort(_entries.begin(), _entries.end(), IsBatchedBefore);
+
+	for (unsigned int i = 0; i < _entries.size(); i++)
+	{
+		const Entry& entry = _entries[i];
+		if (_batches.empty() || _batches.back()._renderObject != entry._renderObject)
+		{
+			Batch batch;
+			batch._renderObject = entry._renderObject;
+			batch._firstInstance = i;
+			batch._nrOfInstances = 0;
+			_batches.push_back(batch);
+		}
+		_batches.back()._nrOfInstances++;
+
+		_instances[i]._world = *entry._world;
+		_instances[i]._colorOffset = DirectX::XMFLOAT4(entry._colorOffset.x, entry._colorOffset.y, entry._colorOffset.z, 0.0f);
+	}
+}
+
+const std::vector<InstanceBatcher::Batch>& InstanceBatcher::GetBatches() const
+{
+	return _batches;
+}
+
+const InstanceData* InstanceBatcher::GetInstances() const
+{
+	return _instances;
+}
+
+unsigned int InstanceBatcher::GetNrOfInstances() const
+{
+	return _entries.size();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "RenderUtils.h"
+
+/*
+Groups the objects to render by RenderObject, so that every group can be drawn with one instanced draw call.
+The instances of all groups are written to one 16 byte aligned array, every group a range of it, so the whole
+array can be sent to the renderer at once. Only the render objects and matrices given are read, the device
+is never touched and no GameObject is needed.
+*/
+class InstanceBatcher
+{
+public:
+	struct Batch
+	{
+		RenderObject* _renderObject;
+		unsigned int _firstInstance;
+		unsigned int _nrOfInstances;
+	};
+
+private:
+	struct Entry
+	{
+		RenderObject* _renderObject;
+		const DirectX::XMMATRIX* _world;
+		DirectX::XMFLOAT3 _colorOffset;
+	};
+
+	std::vector<Entry> _entries;					//Added since the last Clear
+	std::vector<Batch> _batches;
+	InstanceData* _instances;						//Allocated with _mm_malloc to keep the matrices aligned
+	unsigned int _capacity;							//Number of instances _instances has room for
+
+	static bool IsBatchedBefore(const Entry& first, const Entry& second);
+
+	InstanceBatcher(const InstanceBatcher&) = delete;
+	InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+public:
+	InstanceBatcher();
+	~InstanceBatcher();
+
+	void Clear();
+	void Add(RenderObject* renderObject, const DirectX::XMMATRIX* world, DirectX::XMFLOAT3 colorOffset);	//The matrix is read in Build
+	void Build();									//Groups the instances added since the last Clear, keeping their order within a group
+
+	const std::vector<Batch>& GetBatches() const;
+	const InstanceData* GetInstances() const;
+	unsigned int GetNrOfInstances() const;
+};
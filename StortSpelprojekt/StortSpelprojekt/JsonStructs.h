@@ -1,6 +1,6 @@
 #pragma once
 #include <cereal/cereal.hpp>
-#include <cereal\types\vector.hpp>
+#include <cereal/types/vector.hpp>
 
 #include "GameObject.h"
 
@@ -1,5 +1,20 @@
 #include "LightCulling.h"
 
+const float LightCulling::MAX_OBJECT_HEIGHT = 3.0f;
+const float LightCulling::FRUSTUM_MARGIN = 1.0f;
+
+LightCulling::CachedCulling::CachedCulling()
+{
+	_minLeaf = AI::Vec2D(0, 0);
+	_maxLeaf = AI::Vec2D(-1, -1);
+	_isOutdated = true;
+	for (int i = 0; i < System::NR_OF_TYPES; i++)
+	{
+		_objectsOfType[i]._objects = nullptr;
+		_objectsOfType[i]._size = 0;
+	}
+}
+
 void LightCulling::TransformSpotlight(Renderer::Spotlight* spotlight, std::vector<Vec2>* triangle)
 {
 	//Transforming the spotlight to a triangle
@@ -9,38 +24,301 @@ void LightCulling::TransformSpotlight(Renderer::Spotlight* spotlight, std::vecto
 	//Offalign the position a little so it won't get stuck between quads
 	Vec3 pos = Vec3(spotlight->GetPosition())*1.000001f;
 
-	//std::vector<Vec2>* triangle = new std::vector<Vec2>();
 	triangle->push_back(Vec2(pos._x, pos._z));
 	triangle->push_back(Vec2(pos._x, pos._z) + Vec2(range._x, range._z) + Vec2(width._x, width._z));
 	triangle->push_back(Vec2(pos._x, pos._z) + Vec2(range._x, range._z) - Vec2(width._x, width._z));
 }
 
-//Ray LightCulling::CalculateFrustumEdge(float x, float y, System::Camera* camera)
-//{
-//	XMVECTOR determinant;
-//	XMMATRIX inverseViewMatrix = XMMatrixInverse(&determinant, *camera->GetViewMatrix());
-//	XMFLOAT3 mouseViewPos;
-//
-//	XMStoreFloat3(&mouseViewPos, XMVector3TransformCoord(XMVectorSet(x, y, 1.0f, 0.0f), inverseViewMatrix));
-//
-//	Ray ray = Ray(Vec3(camera->GetPosition()), (Vec3(mouseViewPos) - Vec3(camera->GetPosition())));
-//
-//	return ray;
-//}
-//
+/*
+The part of the frustum between the ground and MAX_OBJECT_HEIGHT is found by clipping the 12 edges of the frustum
+against those two planes. The rectangle is the bounding box of what is left, with a margin for units between tiles.
+*/
+bool LightCulling::TransformFrustum(const DirectX::XMMATRIX& viewProjection, std::vector<Vec2>* rectangle)
+{
+	rectangle->clear();
+
+	XMVECTOR determinant;
+	XMMATRIX inverseViewProjection = XMMatrixInverse(&determinant, viewProjection);
+
+	//Corner i is at x = bit 0, y = bit 1 and depth = bit 2 in clip space
+	XMFLOAT3 corners[8];
+	for (int i = 0; i < 8; i++)
+	{
+		XMVECTOR corner = XMVectorSet((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : 0.0f, 1.0f);
+		XMStoreFloat3(&corners[i], XMVector3TransformCoord(corner, inverseViewProjection));
+	}
+
+	bool found = false;
+	float minX = 0.0f, maxX = 0.0f, minZ = 0.0f, maxZ = 0.0f;
+	for (int start = 0; start < 8; start++)
+	{
+		for (int bit = 1; bit < 8; bit <<= 1)
+		{
+			if (start & bit)
+			{
+				continue;
+			}
+			const XMFLOAT3& from = corners[start];
+			const XMFLOAT3& to = corners[start | bit];
+			float dy = to.y - from.y;
+			float first = 0.0f;
+			float last = 1.0f;
+			if (std::abs(dy) < EPSILON)
+			{
+				if (from.y < 0.0f || from.y > MAX_OBJECT_HEIGHT)
+				{
+					continue;
+				}
+			}
+			else
+			{
+				float atGround = -from.y / dy;
+				float atTop = (MAX_OBJECT_HEIGHT - from.y) / dy;
+				first = max(first, min(atGround, atTop));
+				last = min(last, max(atGround, atTop));
+				if (first > last)
+				{
+					continue;
+				}
+			}
+
+			float t[2] = { first, last };
+			for (int i = 0; i < 2; i++)
+			{
+				float x = from.x + (to.x - from.x) * t[i];
+				float z = from.z + (to.z - from.z) * t[i];
+				if (!found)
+				{
+					minX = maxX = x;
+					minZ = maxZ = z;
+					found = true;
+				}
+				minX = min(minX, x);
+				maxX = max(maxX, x);
+				minZ = min(minZ, z);
+				maxZ = max(maxZ, z);
+			}
+		}
+	}
+
+	if (found)
+	{
+		minX -= FRUSTUM_MARGIN;
+		minZ -= FRUSTUM_MARGIN;
+		maxX += FRUSTUM_MARGIN;
+		maxZ += FRUSTUM_MARGIN;
+		rectangle->push_back(Vec2(minX, minZ));
+		rectangle->push_back(Vec2(maxX, minZ));
+		rectangle->push_back(Vec2(maxX, maxZ));
+		rectangle->push_back(Vec2(minX, maxZ));
+	}
+	return found;
+}
+
+/*
+Puts every object except the floors into the quadtree
+*/
+void LightCulling::BuildQuadTree()
+{
+	_quadTree->Clear();
+	for (int x = 0; x < _tilemap->GetWidth(); x++)
+	{
+		for (int z = 0; z < _tilemap->GetHeight(); z++)
+		{
+			std::vector<GameObject*> objects = _tilemap->GetAllObjectsOnTile(x, z);
+			for (unsigned int i = 0; i < objects.size(); i++)
+			{
+				if (objects[i] != nullptr && objects[i]->GetType() != System::FLOOR)
+				{
+					_quadTree->Add(objects[i], AI::Vec2D(x, z));
+				}
+			}
+		}
+	}
+	_tilemapVersion = _tilemap->GetVersion();
+}
+
+/*
+Replays the tilemap changes since the last update on the quadtree.
+Removed objects may already be deleted, so only their pointers and types are used.
+*/
+void LightCulling::UpdateQuadTree()
+{
+	if (_tilemapVersion == _tilemap->GetVersion())
+	{
+		return;
+	}
+	_tilemapChanges.clear();
+	if (!_tilemap->GetChanges(_tilemapVersion, _tilemapChanges))
+	{
+		//Too much has changed to replay
+		BuildQuadTree();
+		for (std::map<Renderer::Spotlight*, CachedCulling>::iterator i = _cachedSpotlights.begin(); i != _cachedSpotlights.end(); i++)
+		{
+			i->second._isOutdated = true;
+		}
+		_cachedFrustum._isOutdated = true;
+		return;
+	}
+	for (unsigned int i = 0; i < _tilemapChanges.size(); i++)
+	{
+		const Tilemap::TileChange& change = _tilemapChanges[i];
+		if (change._oldObject == change._newObject)
+		{
+			continue;
+		}
+		bool changed = false;
+		if (change._oldObject != nullptr && change._oldType != System::FLOOR)
+		{
+			changed = _quadTree->Remove(change._oldObject, change._pos);
+		}
+		if (change._newObject != nullptr && change._newType != System::FLOOR)
+		{
+			_quadTree->Add(change._newObject, change._pos);
+			changed = true;
+		}
+		if (changed)
+		{
+			ClearOutdatedCulling(change._pos);
+		}
+	}
+	_tilemapVersion = _tilemap->GetVersion();
+}
+
+void LightCulling::ClearOutdatedCulling(AI::Vec2D changedTile)
+{
+	int leafX = changedTile._x / QuadTree::LEAF_SIZE;
+	int leafZ = changedTile._y / QuadTree::LEAF_SIZE;
+	for (std::map<Renderer::Spotlight*, CachedCulling>::iterator i = _cachedSpotlights.begin(); i != _cachedSpotlights.end(); i++)
+	{
+		CachedCulling& cachedCulling = i->second;
+		if (leafX >= cachedCulling._minLeaf._x && leafX <= cachedCulling._maxLeaf._x &&
+			leafZ >= cachedCulling._minLeaf._y && leafZ <= cachedCulling._maxLeaf._y)
+		{
+			cachedCulling._isOutdated = true;
+		}
+	}
+	if (leafX >= _cachedFrustum._minLeaf._x && leafX <= _cachedFrustum._maxLeaf._x &&
+		leafZ >= _cachedFrustum._minLeaf._y && leafZ <= _cachedFrustum._maxLeaf._y)
+	{
+		_cachedFrustum._isOutdated = true;
+	}
+}
+
+/*
+Objects sharing a render object and subtype end up next to each other, so the renderer sets their data only once.
+Objects covering several tiles, like traps, are found once per tile and end up next to their copies.
+*/
+bool LightCulling::IsRenderedBefore(GameObject* first, GameObject* second)
+{
+	if (first->GetRenderObject() != second->GetRenderObject())
+	{
+		return first->GetRenderObject() < second->GetRenderObject();
+	}
+	if (first->GetSubType() != second->GetSubType())
+	{
+		return first->GetSubType() < second->GetSubType();
+	}
+	return first < second;
+}
+
+/*
+Searches the quadtree with the cached polygon and stores the result sorted by type
+*/
+void LightCulling::Cull(CachedCulling& cachedCulling)
+{
+	for (int i = 0; i < System::NR_OF_TYPES; i++)
+	{
+		_objectsInLight->at(i).clear();
+	}
+	if (!cachedCulling._polygon.empty())
+	{
+		_quadTree->GetObjects(&cachedCulling._polygon, _objectsInLight);
+	}
+
+	cachedCulling._objects.clear();
+	unsigned int sizes[System::NR_OF_TYPES];
+	for (int i = 0; i < System::NR_OF_TYPES; i++)
+	{
+		std::vector<GameObject*>& objects = _objectsInLight->at(i);
+		std::sort(objects.begin(), objects.end(), IsRenderedBefore);
+		std::vector<GameObject*>::iterator last = std::unique(objects.begin(), objects.end());
+		cachedCulling._objects.insert(cachedCulling._objects.end(), objects.begin(), last);
+		sizes[i] = last - objects.begin();
+	}
+	unsigned int first = 0;
+	for (int i = 0; i < System::NR_OF_TYPES; i++)
+	{
+		cachedCulling._objectsOfType[i]._objects = cachedCulling._objects.data() + first;
+		cachedCulling._objectsOfType[i]._size = sizes[i];
+		first += sizes[i];
+	}
+
+	//Objects are found through the leaves, so any leaf overlapping the bounding box of the polygon can change the result
+	if (cachedCulling._polygon.empty())
+	{
+		cachedCulling._minLeaf = AI::Vec2D(0, 0);
+		cachedCulling._maxLeaf = AI::Vec2D(-1, -1);
+	}
+	else
+	{
+		float minX = cachedCulling._polygon[0]._x, maxX = minX;
+		float minZ = cachedCulling._polygon[0]._y, maxZ = minZ;
+		for (unsigned int i = 1; i < cachedCulling._polygon.size(); i++)
+		{
+			minX = min(minX, cachedCulling._polygon[i]._x);
+			maxX = max(maxX, cachedCulling._polygon[i]._x);
+			minZ = min(minZ, cachedCulling._polygon[i]._y);
+			maxZ = max(maxZ, cachedCulling._polygon[i]._y);
+		}
+		int maxTileX = _tilemap->GetWidth() - 1;
+		int maxTileZ = _tilemap->GetHeight() - 1;
+		cachedCulling._minLeaf._x = max(0, min(maxTileX, (int)std::floor(minX + 0.5f))) / QuadTree::LEAF_SIZE;
+		cachedCulling._minLeaf._y = max(0, min(maxTileZ, (int)std::floor(minZ + 0.5f))) / QuadTree::LEAF_SIZE;
+		cachedCulling._maxLeaf._x = max(0, min(maxTileX, (int)std::floor(maxX + 0.5f))) / QuadTree::LEAF_SIZE;
+		cachedCulling._maxLeaf._y = max(0, min(maxTileZ, (int)std::floor(maxZ + 0.5f))) / QuadTree::LEAF_SIZE;
+	}
+	cachedCulling._isOutdated = false;
+}
+
+/*
+Culls again if _polygon differs from the cached polygon or the tilemap has changed close to it
+*/
+const LightCulling::ObjectSpan* LightCulling::GetCachedObjects(CachedCulling& cachedCulling)
+{
+	UpdateQuadTree();
+
+	bool moved = cachedCulling._polygon.size() != _polygon.size();
+	for (unsigned int i = 0; i < _polygon.size() && !moved; i++)
+	{
+		moved = cachedCulling._polygon[i]._x != _polygon[i]._x || cachedCulling._polygon[i]._y != _polygon[i]._y;
+	}
+	if (moved)
+	{
+		cachedCulling._polygon = _polygon;
+		cachedCulling._isOutdated = true;
+	}
+	if (cachedCulling._isOutdated)
+	{
+		Cull(cachedCulling);
+	}
+	return cachedCulling._objectsOfType;
+}
 
 LightCulling::LightCulling()
 {
 	_tilemap = nullptr;
-	_quadTreeRoot = nullptr;
+	_quadTree = nullptr;
+	_tilemapVersion = 0;
 	_objectsInLight = nullptr;
+	_hasFrustum = false;
 }
 
 LightCulling::LightCulling(Tilemap* tilemap)
 {
 	_tilemap = tilemap;
 	//Align with tilemap
-	_quadTreeRoot = new QuadTree(Vec2(-0.5f,-0.5f), Vec2((float)_tilemap->GetWidth()+0.5f, (float)_tilemap->GetHeight()+0.5f));
+	_quadTree = new QuadTree(_tilemap->GetWidth(), _tilemap->GetHeight());
 
 	_objectsInLight = new std::vector<std::vector<GameObject*>>();
 	_objectsInLight->reserve(System::NR_OF_TYPES);
@@ -49,83 +327,47 @@ LightCulling::LightCulling(Tilemap* tilemap)
 	{
 		_objectsInLight->push_back(std::vector<GameObject*>());
 	}
-	//The quadtree will stop dividing when the quads are x * x small
-	float finalQuadSize = 4 * 4;
-	//Mathemagic!
-	int nrOfDivides = (int)std::ceil(std::log2((_tilemap->GetWidth()*_tilemap->GetHeight()) / finalQuadSize) * 0.5);
+	_hasFrustum = false;
 
-	_quadTreeRoot->Divide(nrOfDivides);
+	BuildQuadTree();
 }
 
 LightCulling::~LightCulling()
 {
 	SAFE_DELETE(_objectsInLight);
-	SAFE_DELETE(_quadTreeRoot);
+	SAFE_DELETE(_quadTree);
 }
 
-std::vector<std::vector<GameObject*>>* LightCulling::GetObjectsInSpotlight(Renderer::Spotlight* spotlight)
+const LightCulling::ObjectSpan* LightCulling::GetObjectsInSpotlight(Renderer::Spotlight* spotlight)
 {
-	std::vector<Vec2> triangle;
-	TransformSpotlight(spotlight, &triangle);
-	
-	for (int i = 0; i <  System::NR_OF_TYPES; i++)
+	_polygon.clear();
+	TransformSpotlight(spotlight, &_polygon);
+	return GetCachedObjects(_cachedSpotlights[spotlight]);
+}
+
+const LightCulling::ObjectSpan* LightCulling::GetObjectsInFrustum(System::Camera* camera)
+{
+	TransformFrustum(XMMatrixMultiply(*camera->GetViewMatrix(), *camera->GetProjectionMatrix()), &_polygon);
+	_hasFrustum = true;
+	return GetCachedObjects(_cachedFrustum);
+}
+
+bool LightCulling::IsSpotlightInFrustum(Renderer::Spotlight* spotlight)
+{
+	if (!_hasFrustum)
 	{
-		_objectsInLight->at(i).clear();
+		return true;
 	}
-	_quadTreeRoot->GetObjects(&triangle, _objectsInLight, _tilemap);
-
-	return _objectsInLight;
-}
-
-//std::vector<std::vector<GameObject*>> LightCulling::GetObjectsInFrustum(System::Camera* camera)
-//{
-//	std::vector<Vec2> frustum;
-//	std::vector<AI::Vec2D> collectedTiles;
-//
-//	std::vector<std::vector<GameObject*>> objectsInFrustum;
-//
-//	for (int i = 0; i < NR_OF_TYPES; i++)
-//	{
-//		objectsInFrustum.push_back(std::vector<GameObject*>());
-//	}
-//
-//	/////////////////
-//	Ray rays[2] = {
-//		CalculateFrustumEdge(-2.0f, 0.0f, camera),
-//		CalculateFrustumEdge(2.0f, 0.0f, camera) };
-//
-//
-//	Vec2 temp = Vec2(rays[0]._origin._x, rays[0]._origin._z);
-//	frustum.push_back(temp);
-//	frustum.push_back(temp + (Vec2(rays[0]._direction._x, rays[0]._direction._z)) * 50);
-//	frustum.push_back(temp + (Vec2(rays[1]._direction._x, rays[1]._direction._z)) * 50);
-//
-//
-//	////////////////////////
-//	//Ray rays[4] = {
-//	//	CalculateFrustumEdge(-1.0f, -1.0f, camera),
-//	//	CalculateFrustumEdge(1.0f, -1.0f, camera),
-//	//	CalculateFrustumEdge(-1.0f, 1.0f, camera),
-//	//	CalculateFrustumEdge(1.0f, 1.0f, camera) };
-//
-//
-//	//Plane pickPlane = Plane(Vec3(), Vec3(0.0f, 1.0f, 0.0f), 0.0f);
-//
-//	//for (int i = 0; i < 4; i++)
-//	//{
-//	//	if (Collision(rays[i], pickPlane))
-//	//	{
-//	//		Vec3 point = Intersection(rays[i], pickPlane);
-//
-//	//		frustum.push_back(Vec2(point._x, point._z));
-//	//	}
-//	//}
-//	///////////////////////////
-//
-//	_quadTreeRoot->GetTiles(frustum, collectedTiles);
-//
-//	GatherObjectsOnTiles(collectedTiles, objectsInFrustum);
-//	
-//
-//	return objectsInFrustum;
-//}
\ No newline at end of file
+	if (_cachedFrustum._polygon.empty())
+	{
+		return false;
+	}
+	_polygon.clear();
+	TransformSpotlight(spotlight, &_polygon);
+	return Collision(&_polygon, &_cachedFrustum._polygon);
+}
+
+void LightCulling::RemoveSpotlight(Renderer::Spotlight* spotlight)
+{
+	_cachedSpotlights.erase(spotlight);
+}
@@ -4,32 +4,84 @@
 #include "GameObject.h"
 #include "Spotlight.h"
 #include "Camera.h"
+#include <map>
+#include <algorithm>
 /*
 Handles both culling for lightning purposes and camera frustum purposes
 
 */
 class LightCulling
 {
+public:
+	/*
+	Read-only view of the objects of one type in a spotlight or the camera frustum
+	*/
+	struct ObjectSpan
+	{
+		GameObject* const* _objects;
+		unsigned int _size;
+	};
+
 private:
+	/*
+	The culling result of one polygon. It is kept until the polygon moves or an object is added to or removed
+	from a leaf the polygon might touch, so static lights are only culled again when something changes around them.
+	*/
+	struct CachedCulling
+	{
+		std::vector<Vec2> _polygon;						//Empty if nothing can be inside, e.g. when the camera looks above the level
+		AI::Vec2D _minLeaf;								//The leaves close enough to the polygon to be in the result
+		AI::Vec2D _maxLeaf;
+		bool _isOutdated;
+		std::vector<GameObject*> _objects;				//Sorted by type
+		ObjectSpan _objectsOfType[System::NR_OF_TYPES];
+
+		CachedCulling();
+	};
+
+	static const float MAX_OBJECT_HEIGHT;				//Objects are assumed to be inside the frustum if any part of them up to this height is
+	static const float FRUSTUM_MARGIN;					//Units are drawn between tiles, so they can be seen up to a tile away from their tile
 
-	QuadTree* _quadTreeRoot;
+	QuadTree* _quadTree;
 	Tilemap* _tilemap;
-	std::vector<std::vector<GameObject*>>* _objectsInLight;
+	unsigned int _tilemapVersion;						//The tilemap version the quadtree is up to date with
+	std::vector<Tilemap::TileChange> _tilemapChanges;
+	std::vector<std::vector<GameObject*>>* _objectsInLight;	//Reused when culling
+	std::map<Renderer::Spotlight*, CachedCulling> _cachedSpotlights;
+	CachedCulling _cachedFrustum;
+	bool _hasFrustum;
+	std::vector<Vec2> _polygon;
+
+	void BuildQuadTree();
+	void UpdateQuadTree();
+	void ClearOutdatedCulling(AI::Vec2D changedTile);
+	void Cull(CachedCulling& cachedCulling);
+	const ObjectSpan* GetCachedObjects(CachedCulling& cachedCulling);
+	static bool IsRenderedBefore(GameObject* first, GameObject* second);
 
 	//LightCulling
 	void TransformSpotlight(Renderer::Spotlight* spotlight, std::vector<Vec2>* triangle);
 
-	//FrustumCulling
-	//Ray CalculateFrustumEdge(float x, float y, System::Camera* camera);
-
+	LightCulling(const LightCulling&) = delete;
+	LightCulling& operator=(const LightCulling&) = delete;
 public:
 
 	LightCulling();
 	LightCulling(Tilemap* tilemap);
 	~LightCulling();
 
-	std::vector<std::vector<GameObject*>>* GetObjectsInSpotlight(Renderer::Spotlight* spotlight);
-	//std::vector<std::vector<GameObject*>> GetObjectsInFrustum(System::Camera* camera);
+	/*
+	Projects the frustum of the view projection matrix onto the ground as a rectangle.
+	Returns false if no part of the frustum is close enough to the ground to see any objects.
+	*/
+	static bool TransformFrustum(const DirectX::XMMATRIX& viewProjection, std::vector<Vec2>* rectangle);
 
+	/*
+	Both return one span per type, sorted so objects sharing a render object are next to each other.
+	The spans stay valid until the same spotlight or the frustum is queried again, or the spotlight is removed
+	*/
+	const ObjectSpan* GetObjectsInSpotlight(Renderer::Spotlight* spotlight);
+	const ObjectSpan* GetObjectsInFrustum(System::Camera* camera);
+	bool IsSpotlightInFrustum(Renderer::Spotlight* spotlight);		//Uses the frustum from the last GetObjectsInFrustum
+	void RemoveSpotlight(Renderer::Spotlight* spotlight);
 };
-
@@ -5,6 +5,7 @@ ObjectHandler::ObjectHandler(ID3D11Device* device, AssetManager* assetManager, G
 	_currentLevelHeader()
 {
 	_settings = settings;
+	GameObject::SetTickLength(1000.0f / (settings->_ticksPerSecond > 0 ? settings->_ticksPerSecond : 60));
 	_idCount = 0;
 	_assetManager = assetManager;
 	_tilemap = new Tilemap();
@@ -12,11 +13,17 @@ ObjectHandler::ObjectHandler(ID3D11Device* device, AssetManager* assetManager, G
 	_gameObjectInfo = data;
 	_device = device;
 	_lightCulling = nullptr;
+	_spatialHash = nullptr;
 	_gameObjects.resize(System::NR_OF_TYPES);
+	_transformStore = new TransformStore();
+	_renderListBatcher = new InstanceBatcher();
 	_particleEventQueue = particleEventQueue;
 	_soundModule = soundModule;
 	_backgroundObject = nullptr;
 	_ambientLight = ambientLight;
+	_visionBatch = new VisionBatch();
+	_visibilityGrid = new VisibilityGrid();
+	_visibilityGrid->Resize(_tilemap->GetWidth(), _tilemap->GetHeight());
 }
 
 ObjectHandler::~ObjectHandler()
@@ -24,6 +31,10 @@ ObjectHandler::~ObjectHandler()
 	UnloadLevel();
 	SAFE_DELETE(_buildingGrid);
 	SAFE_DELETE(_backgroundObject);
+	SAFE_DELETE(_visionBatch);
+	SAFE_DELETE(_visibilityGrid);
+	SAFE_DELETE(_transformStore);
+	SAFE_DELETE(_renderListBatcher);
 }
 
 GameObject* ObjectHandler::Add(System::Blueprint* blueprint, int textureId, const XMFLOAT3& position, const XMFLOAT3& rotation, const bool placeOnTilemap, AI::Vec2D direction)
@@ -118,6 +129,7 @@ GameObject* ObjectHandler::Add(System::Blueprint* blueprint, int textureId, cons
 	{
 		_idCount++;
 		_gameObjects[type].push_back(object);
+		object->SetTransformStore(_transformStore);
 
 		//TODO: remove when proper loading can be done /Jonas
 		if (type == System::GUARD)
@@ -179,6 +191,10 @@ bool ObjectHandler::Remove(int ID)
 
 				if (_spotlights.count(_gameObjects[i][j]))
 				{
+					if (_lightCulling != nullptr)
+					{
+						_lightCulling->RemoveSpotlight(_spotlights[_gameObjects[i][j]]);
+					}
 					delete _spotlights[_gameObjects[i][j]];
 					_spotlights.erase(_gameObjects[i][j]);
 				}
@@ -224,6 +240,10 @@ bool ObjectHandler::Remove(System::Type type, int ID)
 
 			if (_spotlights.count(_gameObjects[type][i]))
 			{
+				if (_lightCulling != nullptr)
+				{
+					_lightCulling->RemoveSpotlight(_spotlights[_gameObjects[type][i]]);
+				}
 				delete _spotlights[_gameObjects[type][i]];
 				_spotlights.erase(_gameObjects[type][i]);
 			}
@@ -299,27 +319,29 @@ vector<GameObject*>* ObjectHandler::GetAllByType(System::Type type)
 	return &_gameObjects[type];
 }
 
+/*
+Game::Render batches all visible objects at once with its own InstanceBatcher, this is for single render objects
+*/
 RenderList ObjectHandler::GetAllByType(int renderObjectID)
 {
-	// TODO make it so that it returns a vector of renderlists to improve performance /Markus
-
 	RenderList list;
 	list._renderObject = _assetManager->GetRenderObject(renderObjectID);
 
-	int count = 0;
+	_renderListBatcher->Clear();
 	for (int i = 0; i < System::NR_OF_TYPES; i++)
 	{
 		for (GameObject* g : _gameObjects[i])
 		{
-			if (g->GetRenderObject() == _assetManager->GetRenderObject(renderObjectID))
+			if (g->GetRenderObject() == list._renderObject)
 			{
-				//TODO _modelMatrices should hold XMMATRIX* instead to ensure proper alignment of the matrices |Jonas a.k.a. ] 0 |\| /-\ 5
-				list._modelMatrices[count] = *g->GetMatrix();
+				_renderListBatcher->Add(list._renderObject, g->GetMatrix(), g->GetColorOffset());
 			}
-			count++;
 		}
 	}
+	_renderListBatcher->Build();
 
+	list._instances = _renderListBatcher->GetInstances();
+	list._nrOfInstances = _renderListBatcher->GetNrOfInstances();
 	return list;
 }
 
@@ -343,6 +365,11 @@ Tilemap * ObjectHandler::GetTileMap() const
 	return _tilemap;
 }
 
+const VisibilityGrid* ObjectHandler::GetVisibilityGrid() const
+{
+	return _visibilityGrid;
+}
+
 void ObjectHandler::SetTileMap(Tilemap * tilemap)
 {
 	if (_tilemap != nullptr)
@@ -352,6 +379,19 @@ void ObjectHandler::SetTileMap(Tilemap * tilemap)
 	_tilemap = tilemap;
 
 	_buildingGrid->ChangeGridSize(_tilemap->GetWidth() - 1, _tilemap->GetHeight() - 1, 1);
+	_visibilityGrid->Resize(_tilemap->GetWidth(), _tilemap->GetHeight());
+
+	//Both keep a pointer to the tilemap
+	if (_lightCulling != nullptr)
+	{
+		delete _lightCulling;
+		_lightCulling = new LightCulling(_tilemap);
+	}
+	if (_spatialHash != nullptr)
+	{
+		delete _spatialHash;
+		_spatialHash = new SpatialHash(_tilemap);
+	}
 }
 
 Grid * ObjectHandler::GetBuildingGrid()
@@ -385,6 +425,7 @@ bool ObjectHandler::LoadLevel(Level::LevelBinary &levelData, bool resizeTileMap)
 	if (resizeTileMap)
 	{
 		_tilemap = new Tilemap(AI::Vec2D(levelData._tileMapMaxX - levelData._tileMapMinX + 4, levelData._tileMapMaxZ - levelData._tileMapMinZ + 4));
+		_visibilityGrid->Resize(_tilemap->GetWidth(), _tilemap->GetHeight());
 	}
 
 	for (int i = 0; i < (int)levelData._gameObjectData.size() && result; i++)
@@ -412,15 +453,18 @@ bool ObjectHandler::LoadLevel(Level::LevelBinary &levelData, bool resizeTileMap)
 		//Set no placement zones on floors
 		if (addedObject != nullptr && formattedGameObject->at(0) == System::Type::FLOOR && formattedGameObject->size() >= 7)
 		{
-			static_cast<Architecture*>(addedObject)->SetNoPlacementZone((bool)formattedGameObject->at(6));
+			_tilemap->SetNoPlacementZone(addedObject->GetTilePosition(), (bool)formattedGameObject->at(6));
 		}
 	}
 
 	_currentAvailableUnits = levelData._availableUnits;
 	_enemySpawnVector = levelData._enemyOrderedSpawnVector;
 	_enemySpawnIndex = 0;
+	_spawnTimer = 0.0f;
+	_nextSpawnCheck = 0.0f;
 
 	_lightCulling = new LightCulling(_tilemap);
+	_spatialHash = new SpatialHash(_tilemap);
 
 	SAFE_DELETE(_backgroundObject);
 	const int sizeX = 90 + _tilemap->GetWidth();
@@ -450,10 +494,16 @@ void ObjectHandler::UnloadLevel()
 	ReleaseGameObjects();
 	SAFE_DELETE(_tilemap);
 	SAFE_DELETE(_lightCulling);
+	SAFE_DELETE(_spatialHash);
+
+	//The objects were deleted one by one above, this only puts the free blocks of their pools back in address order
+	ObjectPool::ResetShared();
 }
 
 void ObjectHandler::Update(float deltaTime)
 {
+	GameObject::SetTickLength(deltaTime);
+
 	//Update all objects' gamelogic
 	for (int i = 0; i < System::NR_OF_TYPES; i++)
 	{
@@ -484,18 +534,9 @@ void ObjectHandler::Update(float deltaTime)
 					heldObject->SetTilePosition(AI::Vec2D((int)heldObject->GetPosition().x, (int)heldObject->GetPosition().z));
 				}
 
-				bool inRangeOfSpawn = false;
-				for (uint k = 0; k < _gameObjects[System::SPAWN].size() && !inRangeOfSpawn; k++)
+				if (!_gameObjects[System::SPAWN].empty())
 				{
-					if (!_gameObjects[System::SPAWN][k]->InRange(unit->GetTilePosition()))
-					{
-						static_cast<Enemy*>(unit)->SetIsAtSpawn(false);
-					}
-					else
-					{
-						static_cast<Enemy*>(unit)->SetIsAtSpawn(true);
-						inRangeOfSpawn = true;
-					}
+					static_cast<Enemy*>(unit)->SetIsAtSpawn(IsAtSpawn(unit->GetTilePosition()));
 				}
 
 
@@ -510,17 +551,14 @@ void ObjectHandler::Update(float deltaTime)
 					if (heldObject != nullptr)
 					{
 						bool lootRemoved = false;
-						for (uint k = 0; k < _gameObjects[System::SPAWN].size() && !lootRemoved; k++)
+						//If the enemy is at the despawn point with an objective, remove the objective and the enemy, Aron
+						if (IsAtSpawn(unit->GetTilePosition()))
 						{
-							//If the enemy is at the despawn point with an objective, remove the objective and the enemy, Aron
-							if (_gameObjects[System::SPAWN][k]->InRange(unit->GetTilePosition()))
-							{
-								lootRemoved = Remove(heldObject);
+							lootRemoved = Remove(heldObject);
 
-								if (_tilemap->GetNrOfLoot() > 0)
-								{
-									_enemySpawnVector.push_back(std::array<int, 2>{_enemySpawnVector.back()[0] + 1, (int)unit->GetSubType()});
-								}
+							if (_tilemap->GetNrOfLoot() > 0)
+							{
+								_enemySpawnVector.push_back(std::array<int, 2>{_enemySpawnVector.back()[0] + 1, (int)unit->GetSubType()});
 							}
 						}
 
@@ -620,21 +658,117 @@ void ObjectHandler::Update(float deltaTime)
 			}
 		}
 	}
-	if (_spawnTimer % 60 == 0 && _tilemap->GetNrOfLoot() > 0)
+	UpdateVision();
+	//Checked on the tick closest to every whole second, so rounding in _spawnTimer can not skip one
+	if (_spawnTimer + deltaTime * 0.5f >= _nextSpawnCheck)
 	{
-		SpawnEnemies();
+		if (_tilemap->GetNrOfLoot() > 0)
+		{
+			SpawnEnemies();
+		}
+		_nextSpawnCheck += 1000.0f;
 	}
-	_spawnTimer++;
+	_spawnTimer += deltaTime;
 	UpdateLights();
 }
 
+void ObjectHandler::BeginTick()
+{
+	_transformStore->BeginTick();
+}
+
+void ObjectHandler::UpdateTransforms(float interpolation)
+{
+	_transformStore->RebuildMatrices(interpolation);
+}
+
+/*
+Spawn points are only in range of the tiles around them, so only the spawn points close by are checked
+*/
+bool ObjectHandler::IsAtSpawn(AI::Vec2D tile)
+{
+	_nearbyObjects.clear();
+	_spatialHash->GetObjectsInRadius(System::SPAWN, tile, AI::SQRT2, _nearbyObjects);
+	for (GameObject* spawn : _nearbyObjects)
+	{
+		if (spawn->InRange(tile))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+Units only ask for their vision cones to be updated while they move, so that all the cones can be found together
+on several threads. The units that wanted to look around get to do so once the cones are done.
+The cones are then combined into what each team sees, and every enemy the guards or cameras see stays visible.
+*/
+void ObjectHandler::UpdateVision()
+{
+	vector<VisionCone*> cones;
+	for (GameObject* g : _gameObjects[System::CAMERA])
+	{
+		if (static_cast<SecurityCamera*>(g)->GetVisionCone()->IsOutdated())
+		{
+			cones.push_back(static_cast<SecurityCamera*>(g)->GetVisionCone());
+		}
+	}
+	for (int i = System::GUARD; i <= System::ENEMY; i++)
+	{
+		for (GameObject* g : _gameObjects[i])
+		{
+			if (static_cast<Unit*>(g)->GetVisionCone()->IsOutdated())
+			{
+				cones.push_back(static_cast<Unit*>(g)->GetVisionCone());
+			}
+		}
+	}
+	_visionBatch->Update(cones);
+
+	for (int i = System::GUARD; i <= System::ENEMY; i++)
+	{
+		for (GameObject* g : _gameObjects[i])
+		{
+			if (static_cast<Unit*>(g)->HasPendingVisionCheck())
+			{
+				static_cast<Unit*>(g)->CheckVisibleTiles();
+			}
+		}
+	}
+
+	_visibilityGrid->Clear();
+	for (GameObject* g : _gameObjects[System::CAMERA])
+	{
+		_visibilityGrid->AddCone(VisibilityGrid::GUARD_TEAM, static_cast<SecurityCamera*>(g)->GetVisionCone());
+	}
+	for (GameObject* g : _gameObjects[System::GUARD])
+	{
+		_visibilityGrid->AddCone(VisibilityGrid::GUARD_TEAM, static_cast<Unit*>(g)->GetVisionCone());
+	}
+	for (GameObject* g : _gameObjects[System::ENEMY])
+	{
+		_visibilityGrid->AddCone(VisibilityGrid::ENEMY_TEAM, static_cast<Unit*>(g)->GetVisionCone());
+	}
+	vector<AI::Vec2D> seenEnemies;
+	_visibilityGrid->GetVisibleEnemies(VisibilityGrid::GUARD_TEAM, _tilemap, seenEnemies);
+	for (AI::Vec2D tile : seenEnemies)
+	{
+		Enemy* enemy = static_cast<Enemy*>(_tilemap->GetObjectOnTile(tile, System::ENEMY));
+		if (enemy != nullptr)
+		{
+			enemy->ResetVisibilityTimer();
+		}
+	}
+}
+
 void ObjectHandler::SpawnEnemies()
 {
 	if ((int)_enemySpawnVector.size() > 0 && _enemySpawnIndex < (int)_enemySpawnVector.size())
 	{
 		int nextEnemySpawnTime = _enemySpawnVector[_enemySpawnIndex][0];
 
-		if (_spawnTimer >= nextEnemySpawnTime * 60)
+		if (_nextSpawnCheck >= nextEnemySpawnTime * 1000.0f)
 		{
 			int nextEnemyType = _enemySpawnVector[_enemySpawnIndex][1];
 			System::Blueprint* nextEnemyBlueprint = _blueprints.GetBlueprintByType(System::ENEMY, nextEnemyType);
@@ -792,11 +926,40 @@ map<GameObject*, Renderer::Pointlight*>* ObjectHandler::GetPointlights()
 	return &_pointlights;
 }
 
-vector<vector<GameObject*>>* ObjectHandler::GetObjectsInLight(Renderer::Spotlight* spotlight)
+const LightCulling::ObjectSpan* ObjectHandler::GetObjectsInLight(Renderer::Spotlight* spotlight)
 {
 	return _lightCulling->GetObjectsInSpotlight(spotlight);
 }
 
+/*
+Held loot is taken off the tilemap, so it is added to the culled loot as it follows the unit holding it
+*/
+const LightCulling::ObjectSpan* ObjectHandler::GetObjectsInFrustum(System::Camera* camera)
+{
+	const LightCulling::ObjectSpan* culled = _lightCulling->GetObjectsInFrustum(camera);
+	for (int i = 0; i < System::NR_OF_TYPES; i++)
+	{
+		_objectsInFrustum[i] = culled[i];
+	}
+
+	_lootInFrustum.assign(culled[System::LOOT]._objects, culled[System::LOOT]._objects + culled[System::LOOT]._size);
+	for (GameObject* loot : _gameObjects[System::LOOT])
+	{
+		if (loot->GetPickUpState() == HELD)
+		{
+			_lootInFrustum.push_back(loot);
+		}
+	}
+	_objectsInFrustum[System::LOOT]._objects = _lootInFrustum.data();
+	_objectsInFrustum[System::LOOT]._size = _lootInFrustum.size();
+	return _objectsInFrustum;
+}
+
+bool ObjectHandler::IsSpotlightInFrustum(Renderer::Spotlight* spotlight)
+{
+	return _lightCulling->IsSpotlightInFrustum(spotlight);
+}
+
 RenderObject* ObjectHandler::GetBackgroundObject()
 {
 	return _backgroundObject;
@@ -14,15 +14,20 @@
 #include "Tilemap.h"
 #include "JsonStructs.h"
 #include "AssetManager.h"
-#include "StateMachine\States.h"
+#include "StateMachine/States.h"
 #include "Spotlight.h"
 #include "Pointlight.h"
 #include "Grid.h"
 #include "Settings/Settings.h"
 #include "LightCulling.h"
+#include "VisionBatch.h"
+#include "VisibilityGrid.h"
+#include "SpatialHash.h"
+#include "TransformStore.h"
+#include "InstanceBatcher.h"
 #include "Blueprints.h"
-#include "ParticleSystem\ParticleUtils.h"
-#include "ParticleSystem\ParticleEventQueue.h"
+#include "ParticleSystem/ParticleUtils.h"
+#include "ParticleSystem/ParticleEventQueue.h"
 #include "AmbientLight.h"
 
 /*
@@ -40,11 +45,12 @@ Returns all objects of a certain Type (i.e. Traps) as a seperate objectHandler
 */
 
 
-//A struct containing 1 renderobject and all the gameobjects' matrices that uses said renderobject
+//One render object and the instances of all gameobjects that use it, ready for one instanced draw call
 struct RenderList
 {
 	RenderObject* _renderObject;
-	vector<XMMATRIX> _modelMatrices;
+	const InstanceData* _instances;			//Aligned, valid until GetAllByType(int) is called again
+	unsigned int _nrOfInstances;
 };
 
 class ObjectHandler
@@ -52,6 +58,8 @@ class ObjectHandler
 private:
 	System::Settings* _settings;
 	vector<vector<GameObject*>> _gameObjects;
+	TransformStore* _transformStore;
+	InstanceBatcher* _renderListBatcher;		//Holds the instances of the last RenderList
 	Blueprints _blueprints;
 	GameObjectInfo* _gameObjectInfo;
 	Tilemap* _tilemap;
@@ -68,6 +76,8 @@ private:
 	map<GameObject*, Renderer::Spotlight*> _spotlights;
 	map<GameObject*, Renderer::Pointlight*> _pointlights;
 	LightCulling* _lightCulling;
+	LightCulling::ObjectSpan _objectsInFrustum[System::NR_OF_TYPES];
+	vector<GameObject*> _lootInFrustum;
 	AmbientLight* _ambientLight;
 
 	//Currently loaded level information
@@ -76,7 +86,14 @@ private:
 	std::vector<std::array<int, 2>> _enemySpawnVector;
 
 	int _enemySpawnIndex = 0;
-	int _spawnTimer = 0;
+	float _spawnTimer = 0.0f;				//Game time in ms since the level was loaded
+	float _nextSpawnCheck = 0.0f;			//The whole second of game time spawning is checked at next
+
+	VisionBatch* _visionBatch;
+	VisibilityGrid* _visibilityGrid;
+	SpatialHash* _spatialHash;
+	vector<GameObject*> _nearbyObjects;			//Reused for spatial hash queries
+	bool IsAtSpawn(AI::Vec2D tile);
 
 	Renderer::ParticleEventQueue* _particleEventQueue;
 
@@ -85,6 +102,7 @@ private:
 
 	void ReleaseGameObjects();
 	void SpawnEnemies();
+	void UpdateVision();
 
 public:
 	ObjectHandler(ID3D11Device* device, AssetManager* assetManager, GameObjectInfo* data, System::Settings* settings, Renderer::ParticleEventQueue* particleReque, System::SoundModule*	soundModule, AmbientLight* ambientLight);
@@ -103,18 +121,21 @@ public:
 
 	//Returns a vector containing all gameobjects with the same type
 	vector<GameObject*>* GetAllByType(System::Type type);
-	//Returns a list of a renderobject and matrices for all objects using the renderobject
+	//Returns a list of a renderobject and the instances of all objects using the renderobject
 	RenderList GetAllByType(int renderObjectID);
 	vector<vector<GameObject*>>* GetGameObjects();
 
 	map<GameObject*, Renderer::Spotlight*>* GetSpotlights();
 	map<GameObject*, Renderer::Pointlight*>* GetPointlights();
-	vector<vector<GameObject*>>* GetObjectsInLight(Renderer::Spotlight* spotlight);
+	const LightCulling::ObjectSpan* GetObjectsInLight(Renderer::Spotlight* spotlight);
+	const LightCulling::ObjectSpan* GetObjectsInFrustum(System::Camera* camera);
+	bool IsSpotlightInFrustum(Renderer::Spotlight* spotlight);
 
 	int GetObjectCount() const;
 	int GetIdCount()const;
 
 	Tilemap* GetTileMap() const;
+	const VisibilityGrid* GetVisibilityGrid() const;
 	void SetTileMap(Tilemap* tilemap);
 	Grid* GetBuildingGrid();
 	RenderObject* GetBackgroundObject();
@@ -132,6 +153,8 @@ public:
 	void Update(float deltaTime);
 	void UpdateLights();
 	void UpdateLightIntensity();
+	void BeginTick();									//Called before every logic tick, so the objects can be interpolated from where they were
+	void UpdateTransforms(float interpolation = 1.0f);	//Rebuilds the matrices of the objects that moved, once per frame before rendering
 
 	vector<System::Blueprint>* GetBlueprints();
 	std::vector<std::vector<System::Blueprint*>>* GetBlueprintsOrderedByType();
@@ -0,0 +1,153 @@
+#include "ObjectPool.h"
+
+/*
+The shared pools live as long as the program, indexed by the block size in steps of ALIGNMENT
+*/
+namespace
+{
+	struct SharedPools
+	{
+		std::vector<ObjectPool*> _pools;
+
+		~SharedPools()
+		{
+			for (unsigned int i = 0; i < _pools.size(); i++)
+			{
+				delete _pools[i];
+			}
+		}
+	};
+
+	SharedPools& GetSharedPools()
+	{
+		static SharedPools sharedPools;
+		return sharedPools;
+	}
+}
+
+ObjectPool::ObjectPool(size_t blockSize, unsigned int blocksPerChunk)
+{
+	//A free block has to fit the pointer to the next one, and every block has to stay aligned
+	_blockSize = ((blockSize > sizeof(void*) ? blockSize : sizeof(void*)) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	_blocksPerChunk = blocksPerChunk > 0 ? blocksPerChunk : 1;
+	_firstFreeBlock = nullptr;
+	_nrOfBlocksInUse = 0;
+}
+
+ObjectPool::~ObjectPool()
+{
+	for (unsigned int i = 0; i < _chunks.size(); i++)
+	{
+		_mm_free(_chunks[i]);
+	}
+}
+
+/*
+The blocks of the new chunk are put first in the free list, in address order
+*/
+void ObjectPool::AddChunk()
+{
+	char* chunk = (char*)_mm_malloc(_blockSize * _blocksPerChunk, ALIGNMENT);
+	_chunks.push_back(chunk);
+	for (unsigned int i = _blocksPerChunk; i > 0; i--)
+	{
+		void* block = chunk + (i - 1) * _blockSize;
+		*(void**)block = _firstFreeBlock;
+		_firstFreeBlock = block;
+	}
+}
+
+void* ObjectPool::Allocate()
+{
+	if (_firstFreeBlock == nullptr)
+	{
+		AddChunk();
+	}
+	void* block = _firstFreeBlock;
+	_firstFreeBlock = *(void**)block;
+	_nrOfBlocksInUse++;
+	return block;
+}
+
+void ObjectPool::Free(void* block)
+{
+	if (block == nullptr)
+	{
+		return;
+	}
+	*(void**)block = _firstFreeBlock;
+	_firstFreeBlock = block;
+	_nrOfBlocksInUse--;
+}
+
+bool ObjectPool::Reset()
+{
+	if (_nrOfBlocksInUse > 0)
+	{
+		return false;
+	}
+	_firstFreeBlock = nullptr;
+	for (unsigned int i = _chunks.size(); i > 0; i--)
+	{
+		for (unsigned int j = _blocksPerChunk; j > 0; j--)
+		{
+			void* block = _chunks[i - 1] + (j - 1) * _blockSize;
+			*(void**)block = _firstFreeBlock;
+			_firstFreeBlock = block;
+		}
+	}
+	return true;
+}
+
+unsigned int ObjectPool::GetNrOfBlocksInUse() const
+{
+	return _nrOfBlocksInUse;
+}
+
+ObjectPool* ObjectPool::GetSharedPool(size_t size)
+{
+	std::vector<ObjectPool*>& pools = GetSharedPools()._pools;
+	unsigned int index = (size > 0 ? size + ALIGNMENT - 1 : ALIGNMENT) / ALIGNMENT;
+	if (index >= pools.size())
+	{
+		pools.resize(index + 1, nullptr);
+	}
+	if (pools[index] == nullptr)
+	{
+		pools[index] = new ObjectPool(index * ALIGNMENT);
+	}
+	return pools[index];
+}
+
+void* ObjectPool::AllocateShared(size_t size)
+{
+	if (size > MAX_SHARED_BLOCK_SIZE)
+	{
+		return _mm_malloc(size, ALIGNMENT);
+	}
+	return GetSharedPool(size)->Allocate();
+}
+
+void ObjectPool::FreeShared(void* block, size_t size)
+{
+	if (size > MAX_SHARED_BLOCK_SIZE)
+	{
+		_mm_free(block);
+	}
+	else
+	{
+		GetSharedPool(size)->Free(block);
+	}
+}
+
+void ObjectPool::ResetShared()
+{
+	std::vector<ObjectPool*>& pools = GetSharedPools()._pools;
+	for (unsigned int i = 0; i < pools.size(); i++)
+	{
+		if (pools[i] != nullptr)
+		{
+			pools[i]->Reset();
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <xmmintrin.h>
+
+/*
+Hands out blocks of one size, carved out of 16 byte aligned chunks. Freed blocks are reused before a new chunk is
+allocated, and chunks are only given back when the pool is destroyed, so a block never moves and allocating is
+free of heap calls once the pool has grown to the number of blocks a level needs.
+
+The shared pools, one per block size, back the operator new of game objects and their vision cones. Every concrete
+class has its own size, so in practice this is one pool per type.
+*/
+class ObjectPool
+{
+private:
+	static const unsigned int ALIGNMENT = 16;
+	static const size_t MAX_SHARED_BLOCK_SIZE = 4096;		//Bigger allocations go straight to _mm_malloc
+
+	size_t _blockSize;
+	unsigned int _blocksPerChunk;
+	std::vector<char*> _chunks;
+	void* _firstFreeBlock;									//Every free block starts with a pointer to the next
+	unsigned int _nrOfBlocksInUse;
+
+	void AddChunk();
+	static ObjectPool* GetSharedPool(size_t size);
+
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+public:
+	static const unsigned int DEFAULT_BLOCKS_PER_CHUNK = 64;
+
+	ObjectPool(size_t blockSize, unsigned int blocksPerChunk = DEFAULT_BLOCKS_PER_CHUNK);
+	~ObjectPool();
+
+	void* Allocate();
+	void Free(void* block);
+	/*
+	Makes every block free again in one go, in address order. Must only be called when no block is in use,
+	since the destructors of what was in them are not called. Returns false and does nothing otherwise
+	*/
+	bool Reset();
+	unsigned int GetNrOfBlocksInUse() const;
+
+	static void* AllocateShared(size_t size);
+	static void FreeShared(void* block, size_t size);	//size must be the same as when allocated
+	/*
+	Resets the shared pools that have no blocks in use. Nothing is freed by this, the blocks must already have been
+	given back one by one. ObjectHandler::UnloadLevel calls it after deleting every object of the level, only so that
+	the next level is handed its blocks in address order again
+	*/
+	static void ResetShared();
+};
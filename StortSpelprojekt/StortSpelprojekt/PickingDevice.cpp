@@ -1,4 +1,5 @@
 #include "PickingDevice.h"
+#include <memory>
 
 PickingDevice::PickingDevice(System::Camera* camera, System::Settings* settings)
 {
@@ -134,17 +135,26 @@ vector<GameObject*> PickingDevice::BoxPickObjects(POINT mousePoint, vector<GameO
 
 	if (legitForReal)
 	{
-		std::vector<Vec2> point;
+		//The positions are tested as squares without size, all in one batch
 		std::vector<Vec2> box = CreatePickBox(points);
-		for (unsigned int i = 0; i < pickableObjects.size(); i++)
+		unsigned int size = pickableObjects.size();
+		std::vector<float> positionsX(size);
+		std::vector<float> positionsZ(size);
+		for (unsigned int i = 0; i < size; i++)
 		{
-			Vec3 pos = Vec3(pickableObjects[i]->GetPosition());
-			point.push_back(Vec2(pos._x, pos._z));
-			if (Collision(&point, &box))
+			XMFLOAT3 pos = pickableObjects[i]->GetPosition();
+			positionsX[i] = pos.x;
+			positionsZ[i] = pos.z;
+		}
+
+		std::unique_ptr<bool[]> collisions(new bool[size]);
+		Collision(&box, positionsX.data(), positionsZ.data(), positionsX.data(), positionsZ.data(), size, collisions.get());
+		for (unsigned int i = 0; i < size; i++)
+		{
+			if (collisions[i])
 			{
 				pickedObjects.push_back(pickableObjects[i]);
 			}
-			point.clear();
 		}
 	}
 
@@ -158,7 +168,7 @@ AI::Vec2D PickingDevice::PickDirection(POINT mousePoint, Tilemap* tilemap)
 	//Get picked tile
 	AI::Vec2D pickedTile = PickTile(mousePoint);
 	//Get all objects on that tile. Dont care of the type, so just take the first.
-	vector<GameObject*> object = *tilemap->GetAllObjectsOnTile(pickedTile);
+	vector<GameObject*> object = tilemap->GetAllObjectsOnTile(pickedTile);
 	//Actually click something
 	if (object.size() > 0)
 	{
@@ -357,7 +367,7 @@ vector<GameObject*> PickingDevice::PickObjects(POINT mousePoint, const vector<Ga
 
 	return pickedObjects;
 }
-vector<GameObject*>* PickingDevice::PickTilemap(POINT mousePoint, Tilemap* tilemap)
+vector<GameObject*> PickingDevice::PickTilemap(POINT mousePoint, Tilemap* tilemap)
 {
 	return tilemap->GetAllObjectsOnTile(PickTile(mousePoint));
 }
@@ -1,119 +1,161 @@
 #include "QuadTree.h"
 
-QuadTree::QuadTree(Vec2 minPoint, Vec2 maxPoint)
+/*
+Moves the lower 16 bits of value to the even bits
+*/
+unsigned int QuadTree::SpreadBits(unsigned int value)
 {
-	//3 _______ 2
-	// |       |
-	// |       |
-	// |       |
-	//0|_______|1
+	value &= 0x0000ffff;
+	value = (value | (value << 8)) & 0x00ff00ff;
+	value = (value | (value << 4)) & 0x0f0f0f0f;
+	value = (value | (value << 2)) & 0x33333333;
+	value = (value | (value << 1)) & 0x55555555;
+	return value;
+}
 
-	_boundry.push_back(minPoint);
-	_boundry.push_back(Vec2(maxPoint._x, minPoint._y));
-	_boundry.push_back(maxPoint);
-	_boundry.push_back(Vec2(minPoint._x, maxPoint._y));
+unsigned int QuadTree::GetMortonCode(int x, int z)
+{
+	return SpreadBits(x) | (SpreadBits(z) << 1);
+}
 
-	for (int i = 0; i < 4; i++)
-	{
-		_children[i] = nullptr;
-	}
-	_isLeaf = true;
-	_tiles = std::vector<AI::Vec2D>();
+/*
+Level l has 4^l nodes, so it starts after (4^l - 1) / 3 nodes
+*/
+int QuadTree::GetLevelOffset(int level)
+{
+	return ((1 << (2 * level)) - 1) / 3;
 }
 
-QuadTree::~QuadTree()
+int QuadTree::GetLeaf(AI::Vec2D tile) const
+{
+	return GetMortonCode(tile._x / LEAF_SIZE, tile._y / LEAF_SIZE);
+}
+
+void QuadTree::AddToCount(int leaf, int change)
 {
-	for (int i = 0; i < 4; i++)
+	int code = leaf;
+	for (int level = _depth; level >= 0; level--)
 	{
-		SAFE_DELETE(_children[i]);
+		_nrOfObjects[GetLevelOffset(level) + code] += change;
+		code >>= 2;
 	}
 }
 
-void QuadTree::Divide(int nrOfDivisions)
+QuadTree::QuadTree(int width, int height)
 {
-	if (nrOfDivisions > 0)
+	_depth = 0;
+	while ((LEAF_SIZE << _depth) < width || (LEAF_SIZE << _depth) < height)
 	{
-		int nrOfDivisionsLeft = --nrOfDivisions;
-		_isLeaf = false;
-		//Middlepoint between min point and max point
-		Vec2 midPos = (_boundry.at(0) + _boundry.at(2))*0.5f;
-		//First child
-		//	
-		//	|_____
-		//	|     |
-		//	|_____|__
-		_children[0] = new QuadTree(_boundry.at(0), midPos);
-		_children[0]->Divide(nrOfDivisions);
-
-		//Second child
-		//	   
-		//	   _____|
-		//	  |     |
-		//	__|_____|
-		_children[1] = new QuadTree(Vec2(midPos._x, _boundry.at(0)._y), Vec2(_boundry.at(2)._x, midPos._y));
-		_children[1]->Divide(nrOfDivisions);
-
-		//Third child
-		//	 _______
-		//	  |     |
-		//	  |_____|
-		//	        |
-		_children[2] = new QuadTree(midPos, _boundry.at(2));
-		_children[2]->Divide(nrOfDivisions);
-
-		//Fourth child
-		//	 _______
-		//	|     |
-		//	|_____|
-		//	|
-		_children[3] = new QuadTree(Vec2(_boundry.at(0)._x, midPos._y), Vec2(midPos._x, _boundry.at(2)._y));
-		_children[3]->Divide(nrOfDivisions);
+		_depth++;
 	}
-	else
+	_minX.resize(GetLevelOffset(_depth + 1));
+	_minZ.resize(GetLevelOffset(_depth + 1));
+	_maxX.resize(GetLevelOffset(_depth + 1));
+	_maxZ.resize(GetLevelOffset(_depth + 1));
+	_nrOfObjects.resize(GetLevelOffset(_depth + 1), 0);
+	_leaves.resize(1 << (2 * _depth));
+
+	//Tiles are centered on whole coordinates, so a quad of tiles reaches half a tile outside them
+	for (int level = 0; level <= _depth; level++)
 	{
-		//Loop through width/x
-		for (int x = (int)_boundry.at(0)._x; x < (int)_boundry.at(2)._x+1; x++)
+		int nrOfQuadsPerSide = 1 << level;
+		float quadSize = (float)(LEAF_SIZE << (_depth - level));
+		for (int x = 0; x < nrOfQuadsPerSide; x++)
 		{
-			//Loop through height/y
-			for (int y = (int)_boundry.at(0)._y; y < (int)_boundry.at(2)._y+1; y++)
+			for (int z = 0; z < nrOfQuadsPerSide; z++)
 			{
-				_tiles.push_back(AI::Vec2D(x, y));
+				int node = GetLevelOffset(level) + GetMortonCode(x, z);
+				_minX[node] = x * quadSize - 0.5f;
+				_minZ[node] = z * quadSize - 0.5f;
+				_maxX[node] = (x + 1) * quadSize - 0.5f;
+				_maxZ[node] = (z + 1) * quadSize - 0.5f;
 			}
 		}
 	}
 }
-void QuadTree::GetObjects(std::vector<Vec2>* polygon, std::vector<std::vector<GameObject*>>* collectedObjects, Tilemap* tilemap)
+
+QuadTree::~QuadTree()
+{}
+
+void QuadTree::Add(GameObject* object, AI::Vec2D tile)
+{
+	int leaf = GetLeaf(tile);
+	_leaves[leaf].push_back(object);
+	AddToCount(leaf, 1);
+}
+
+bool QuadTree::Remove(GameObject* object, AI::Vec2D tile)
 {
-	if (Collision(polygon, &_boundry))
+	int leaf = GetLeaf(tile);
+	std::vector<GameObject*>& objects = _leaves[leaf];
+	for (unsigned int i = 0; i < objects.size(); i++)
 	{
-		if (_isLeaf)
+		if (objects[i] == object)
 		{
-			//Gather all objects from the tile and add them into the main vector
-			unsigned int size = _tiles.size();
-			for (unsigned int i = 0; i < size; i++)
-			{
-				AI::Vec2D tile = _tiles.at(i);
+			objects[i] = objects.back();
+			objects.pop_back();
+			AddToCount(leaf, -1);
+			return true;
+		}
+	}
+	return false;
+}
 
-				//Start on 1 to skip the floor
-				for (unsigned int j = 1; j < System::NR_OF_TYPES; j++)
-				{
-					GameObject* object = tilemap->GetObjectOnTile(tile, System::Type(j));
-					if (object != nullptr)
-					{
-						collectedObjects->at(j).push_back(object);
-					}
-				}
+void QuadTree::Clear()
+{
+	for (unsigned int i = 0; i < _leaves.size(); i++)
+	{
+		_leaves[i].clear();
+	}
+	_nrOfObjects.assign(_nrOfObjects.size(), 0);
+}
 
+/*
+Walks the tree without recursion. Only quads that touch the polygon and have objects in them wait to be searched,
+and the four children of a searched quad are tested together since their bounds are next to each other
+*/
+void QuadTree::GetObjects(std::vector<Vec2>* polygon, std::vector<std::vector<GameObject*>>* collectedObjects)
+{
+	const int MAX_NR_OF_WAITING_QUADS = 3 * 16 + 1;		//Three siblings wait on every level while the fourth is searched
+	int waitingLevels[MAX_NR_OF_WAITING_QUADS];
+	unsigned int waitingCodes[MAX_NR_OF_WAITING_QUADS];
+	bool collisions[4];
+	int nrOfWaitingQuads = 0;
 
+	Collision(polygon, &_minX[0], &_minZ[0], &_maxX[0], &_maxZ[0], 1, collisions);
+	if (collisions[0] && _nrOfObjects[0] > 0)
+	{
+		waitingLevels[0] = 0;
+		waitingCodes[0] = 0;
+		nrOfWaitingQuads = 1;
+	}
+
+	while (nrOfWaitingQuads > 0)
+	{
+		nrOfWaitingQuads--;
+		int level = waitingLevels[nrOfWaitingQuads];
+		unsigned int code = waitingCodes[nrOfWaitingQuads];
+		if (level == _depth)
+		{
+			const std::vector<GameObject*>& objects = _leaves[code];
+			for (unsigned int i = 0; i < objects.size(); i++)
+			{
+				collectedObjects->at(objects[i]->GetType()).push_back(objects[i]);
 			}
 		}
 		else
 		{
+			int firstChild = GetLevelOffset(level + 1) + (code << 2);
+			Collision(polygon, &_minX[firstChild], &_minZ[firstChild], &_maxX[firstChild], &_maxZ[firstChild], 4, collisions);
 			for (int i = 0; i < 4; i++)
 			{
-				_children[i]->GetObjects(polygon, collectedObjects, tilemap);
+				if (collisions[i] && _nrOfObjects[firstChild + i] > 0)
+				{
+					waitingLevels[nrOfWaitingQuads] = level + 1;
+					waitingCodes[nrOfWaitingQuads] = (code << 2) + i;
+					nrOfWaitingQuads++;
+				}
 			}
 		}
 	}
 }
-
@@ -5,21 +5,40 @@
 #include "Tilemap.h"
 #include "stdafx.h"
 
+/*
+Linear quadtree over the tilemap. Instead of nodes pointing to their children, every level is stored in a flat
+array ordered by Morton code, so the children of node i are nodes 4i to 4i + 3 of the level below.
+The leaves hold the objects actually on their tiles and are kept up to date as objects are added, moved and removed.
+Subtrees without objects are skipped when searching.
+The bounds are stored one array per side, so the four children of a node can be tested against the polygon in one batch.
+*/
 class QuadTree
 {
 private:
+	int _depth;										//Number of levels below the root
+	std::vector<float> _minX;						//Bounds of every node, level by level
+	std::vector<float> _minZ;
+	std::vector<float> _maxX;
+	std::vector<float> _maxZ;
+	std::vector<int> _nrOfObjects;					//Objects in the subtree of every node, level by level
+	std::vector<std::vector<GameObject*>> _leaves;	//Objects in every leaf, indexed by Morton code
 
-	std::vector<Vec2> _boundry; //Four points of an aligned square
-	QuadTree* _children[4];
-	bool _isLeaf;
-	std::vector<AI::Vec2D> _tiles; //Will be empty for all nodes except leaves
+	static unsigned int SpreadBits(unsigned int value);
+	static unsigned int GetMortonCode(int x, int z);
+	static int GetLevelOffset(int level);
+	int GetLeaf(AI::Vec2D tile) const;
+	void AddToCount(int leaf, int change);			//Changes the count of the leaf and all its ancestors
 
+	QuadTree(const QuadTree&) = delete;
+	QuadTree& operator=(const QuadTree&) = delete;
 public:
+	static const int LEAF_SIZE = 4;					//The tree stops dividing when the quads are LEAF_SIZE * LEAF_SIZE tiles
 
-	QuadTree(Vec2 minPoint = Vec2(), Vec2 maxPoint = Vec2());
+	QuadTree(int width, int height);
 	~QuadTree();
 
-	void Divide(int nrOfDivisions);
-	void GetObjects(std::vector<Vec2>* polygon, std::vector<std::vector<GameObject*>>* collectedObjects, Tilemap* tilemap);
-
-};
\ No newline at end of file
+	void Add(GameObject* object, AI::Vec2D tile);
+	bool Remove(GameObject* object, AI::Vec2D tile);
+	void Clear();
+	void GetObjects(std::vector<Vec2>* polygon, std::vector<std::vector<GameObject*>>* collectedObjects);
+};
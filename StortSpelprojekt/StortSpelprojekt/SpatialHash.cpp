@@ -0,0 +1,216 @@
+#include "SpatialHash.h"
+
+SpatialHash::SpatialHash(const Tilemap* tilemap, int cellSize)
+{
+	_tilemap = tilemap;
+	_cellSize = max(1, cellSize);
+	_nrOfCellsX = (_tilemap->GetWidth() + _cellSize - 1) / _cellSize;
+	_nrOfCellsZ = (_tilemap->GetHeight() + _cellSize - 1) / _cellSize;
+	for (int i = 0; i < System::NR_OF_TYPES; i++)
+	{
+		_cells[i].resize(_nrOfCellsX * _nrOfCellsZ);
+	}
+	Build();
+}
+
+SpatialHash::~SpatialHash()
+{}
+
+int SpatialHash::GetCellIndex(AI::Vec2D tile) const
+{
+	return (tile._y / _cellSize) * _nrOfCellsX + tile._x / _cellSize;
+}
+
+void SpatialHash::Add(GameObject* object, System::Type type, AI::Vec2D tile)
+{
+	Entry entry;
+	entry._object = object;
+	entry._tile = tile;
+	_cells[type][GetCellIndex(tile)].push_back(entry);
+}
+
+void SpatialHash::Remove(GameObject* object, System::Type type, AI::Vec2D tile)
+{
+	std::vector<Entry>& cell = _cells[type][GetCellIndex(tile)];
+	for (unsigned int i = 0; i < cell.size(); i++)
+	{
+		if (cell[i]._object == object && cell[i]._tile == tile)
+		{
+			cell[i] = cell.back();
+			cell.pop_back();
+			return;
+		}
+	}
+}
+
+/*
+	Puts every object except the floors into the grid
+*/
+void SpatialHash::Build()
+{
+	for (int i = 0; i < System::NR_OF_TYPES; i++)
+	{
+		for (unsigned int j = 0; j < _cells[i].size(); j++)
+		{
+			_cells[i][j].clear();
+		}
+	}
+	for (int x = 0; x < _tilemap->GetWidth(); x++)
+	{
+		for (int z = 0; z < _tilemap->GetHeight(); z++)
+		{
+			std::vector<GameObject*> objects = _tilemap->GetAllObjectsOnTile(x, z);
+			for (unsigned int i = 0; i < objects.size(); i++)
+			{
+				if (objects[i] != nullptr && objects[i]->GetType() != System::FLOOR)
+				{
+					Add(objects[i], objects[i]->GetType(), AI::Vec2D(x, z));
+				}
+			}
+		}
+	}
+	_tilemapVersion = _tilemap->GetVersion();
+}
+
+/*
+	Replays the tilemap changes since the last query. Removed objects may already be deleted,
+	so only their pointers and the types logged with them are used.
+*/
+void SpatialHash::Update()
+{
+	if (_tilemapVersion == _tilemap->GetVersion())
+	{
+		return;
+	}
+	_tilemapChanges.clear();
+	if (!_tilemap->GetChanges(_tilemapVersion, _tilemapChanges))
+	{
+		Build();
+		return;
+	}
+	for (unsigned int i = 0; i < _tilemapChanges.size(); i++)
+	{
+		const Tilemap::TileChange& change = _tilemapChanges[i];
+		if (change._oldObject == change._newObject)
+		{
+			continue;
+		}
+		if (change._oldObject != nullptr && change._oldType != System::FLOOR)
+		{
+			Remove(change._oldObject, change._oldType, change._pos);
+		}
+		if (change._newObject != nullptr && change._newType != System::FLOOR)
+		{
+			Add(change._newObject, change._newType, change._pos);
+		}
+	}
+	_tilemapVersion = _tilemap->GetVersion();
+}
+
+void SpatialHash::GetObjectsInRadius(System::Type type, AI::Vec2D center, float radius, std::vector<GameObject*>& objects)
+{
+	Update();
+
+	//Octile distance is never shorter than the largest of the x and z distances
+	int reach = (int)radius;
+	int minCellX = max(0, center._x - reach) / _cellSize;
+	int minCellZ = max(0, center._y - reach) / _cellSize;
+	int maxCellX = min(_nrOfCellsX - 1, max(0, center._x + reach) / _cellSize);
+	int maxCellZ = min(_nrOfCellsZ - 1, max(0, center._y + reach) / _cellSize);
+
+	unsigned int first = objects.size();
+	for (int z = minCellZ; z <= maxCellZ; z++)
+	{
+		for (int x = minCellX; x <= maxCellX; x++)
+		{
+			const std::vector<Entry>& cell = _cells[type][z * _nrOfCellsX + x];
+			for (unsigned int i = 0; i < cell.size(); i++)
+			{
+				if (AI::GetOctileDistance(center, cell[i]._tile) <= radius)
+				{
+					objects.push_back(cell[i]._object);
+				}
+			}
+		}
+	}
+
+	//Objects covering several tiles are only added once
+	std::sort(objects.begin() + first, objects.end());
+	objects.erase(std::unique(objects.begin() + first, objects.end()), objects.end());
+}
+
+/*
+	Objects covering several tiles can be candidates several times, only the closest is kept
+*/
+void SpatialHash::MergeCandidates()
+{
+	std::sort(_candidates.begin(), _candidates.end(), [](const std::pair<float, GameObject*>& first, const std::pair<float, GameObject*>& second)
+	{
+		return first.second != second.second ? first.second < second.second : first.first < second.first;
+	});
+	_candidates.erase(std::unique(_candidates.begin(), _candidates.end(), [](const std::pair<float, GameObject*>& first, const std::pair<float, GameObject*>& second)
+	{
+		return first.second == second.second;
+	}), _candidates.end());
+}
+
+/*
+	Searches rings of cells around the cell of center. A cell in ring r is at least (r - 1) * _cellSize + 1 tiles away,
+	so the search stops when k objects closer than that have been found.
+*/
+void SpatialHash::GetNearest(System::Type type, AI::Vec2D center, int k, std::vector<GameObject*>& objects)
+{
+	Update();
+	if (k <= 0)
+	{
+		return;
+	}
+
+	_candidates.clear();
+	int centerX = min(_nrOfCellsX - 1, max(0, center._x / _cellSize));
+	int centerZ = min(_nrOfCellsZ - 1, max(0, center._y / _cellSize));
+	int maxRing = max(max(centerX, _nrOfCellsX - 1 - centerX), max(centerZ, _nrOfCellsZ - 1 - centerZ));
+	for (int ring = 0; ring <= maxRing; ring++)
+	{
+		if (ring > 0 && (int)_candidates.size() >= k)
+		{
+			MergeCandidates();
+			if ((int)_candidates.size() >= k)
+			{
+				std::nth_element(_candidates.begin(), _candidates.begin() + k - 1, _candidates.end());
+				if (_candidates[k - 1].first < (ring - 1) * _cellSize + 1)
+				{
+					break;
+				}
+			}
+		}
+		for (int z = centerZ - ring; z <= centerZ + ring; z++)
+		{
+			if (z < 0 || z >= _nrOfCellsZ)
+			{
+				continue;
+			}
+			//Only the edge of the ring is new, the inside has already been searched
+			int step = (z == centerZ - ring || z == centerZ + ring) ? 1 : max(1, 2 * ring);
+			for (int x = centerX - ring; x <= centerX + ring; x += step)
+			{
+				if (x < 0 || x >= _nrOfCellsX)
+				{
+					continue;
+				}
+				const std::vector<Entry>& cell = _cells[type][z * _nrOfCellsX + x];
+				for (unsigned int i = 0; i < cell.size(); i++)
+				{
+					_candidates.push_back(std::pair<float, GameObject*>(AI::GetOctileDistance(center, cell[i]._tile), cell[i]._object));
+				}
+			}
+		}
+	}
+
+	MergeCandidates();
+	std::sort(_candidates.begin(), _candidates.end());
+	for (unsigned int i = 0; i < _candidates.size() && (int)i < k; i++)
+	{
+		objects.push_back(_candidates[i].second);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "Tilemap.h"
+
+/*
+	Uniform grid of cells, each covering _cellSize * _cellSize tiles, with a list of objects per type in every cell.
+	Kept up to date from the tilemap change journal, so objects are moved between cells as units switch tiles.
+	Objects that are not on the tilemap, like held loot, are not in the grid.
+	Distances are octile, the same as Unit::GetApproxDistance.
+*/
+class SpatialHash
+{
+private:
+	struct Entry
+	{
+		GameObject* _object;
+		AI::Vec2D _tile;					//Traps are in the grid once for every tile they cover
+	};
+
+	const Tilemap* _tilemap;
+	unsigned int _tilemapVersion;
+	std::vector<Tilemap::TileChange> _tilemapChanges;
+	int _cellSize;
+	int _nrOfCellsX;
+	int _nrOfCellsZ;
+	std::vector<std::vector<Entry>> _cells[System::NR_OF_TYPES];		//Indexed by z * _nrOfCellsX + x
+	std::vector<std::pair<float, GameObject*>> _candidates;			//Reused by GetNearest
+
+	int GetCellIndex(AI::Vec2D tile) const;
+	void Add(GameObject* object, System::Type type, AI::Vec2D tile);
+	void Remove(GameObject* object, System::Type type, AI::Vec2D tile);
+	void Build();
+	void Update();
+	void MergeCandidates();
+
+	SpatialHash(const SpatialHash&) = delete;
+	SpatialHash& operator=(const SpatialHash&) = delete;
+public:
+	static const int DEFAULT_CELL_SIZE = 8;
+
+	SpatialHash(const Tilemap* tilemap, int cellSize = DEFAULT_CELL_SIZE);
+	~SpatialHash();
+
+	/*
+		Appends the objects of the type at most radius from center
+	*/
+	void GetObjectsInRadius(System::Type type, AI::Vec2D center, float radius, std::vector<GameObject*>& objects);
+	/*
+		Appends the k objects of the type closest to center, closest first. Fewer if there are not that many
+	*/
+	void GetNearest(System::Type type, AI::Vec2D center, int k, std::vector<GameObject*>& objects);
+};
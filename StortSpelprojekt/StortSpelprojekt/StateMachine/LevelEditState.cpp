@@ -28,7 +28,7 @@ void LevelEditState::Update(float deltaTime)
 				if (tilemap->IsTypeOnTile(pickedTileCoord, System::Type::FLOOR))
 				{
 					Architecture* pickedFloor = static_cast<Architecture*>(tilemap->GetObjectOnTile(pickedTileCoord, System::Type::FLOOR));
-					pickedFloor->SetNoPlacementZone(!pickedFloor->GetNoPlacementZone());
+					tilemap->SetNoPlacementZone(pickedTileCoord, !pickedFloor->GetNoPlacementZone());
 
 					if (pickedFloor->GetNoPlacementZone())
 					{
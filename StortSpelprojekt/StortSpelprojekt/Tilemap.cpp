@@ -2,43 +2,29 @@
 
 Tilemap::Tilemap()
 {
-	_height = 10;
-	_width = 10;
-	_nrOfLoot = 0;
-	_map = new Tile*[_width];
-
-	for (int i = 0; i < _width; i++)
-	{
-		_map[i] = new Tile[_height];
-
-		for (int j = 0; j < _height; j++)
-		{
-			_map[i][j] = Tile();
-		}
-	}
+	_pathfinding = nullptr;
+	Create(10, 10);
 }
 
 Tilemap::Tilemap(AI::Vec2D size)
 {
+	_pathfinding = nullptr;
 	if (size._x > 0 && size._y > 0)
 	{
-		_height = size._y;
-		_width = size._x;
+		Create(size._x, size._y);
+	}
+	else
+	{
+		_height = 0;
+		_width = 0;
 		_nrOfLoot = 0;
-		_map = new Tile*[_width];
-		for (int i = 0; i < _width; i++)
-		{
-			_map[i] = new Tile[_height];
-
-			for (int j = 0; j < _height; j++)
-			{
-				_map[i][j] = Tile();
-			}
-		}
+		_version = 0;
+		_nrOfWordsPerRow = 0;
 	}
 }
 Tilemap::Tilemap(const Tilemap& copy)
 {
+	_pathfinding = nullptr;
 	Copy(copy);
 }
 
@@ -48,32 +34,158 @@ Tilemap& Tilemap::operator=(const Tilemap& copy)
 	return *this;
 }
 
+void Tilemap::Create(int width, int height)
+{
+	_height = height;
+	_width = width;
+	_nrOfLoot = 0;
+	for (int i = 0; i < NR_OF_LAYERS; i++)
+	{
+		_layers[i].assign(width * height, nullptr);
+	}
+	_flags.assign(width * height, 0);
+	_nrOfWordsPerRow = (width + 63) / 64;
+	_enemyBits.assign(_nrOfWordsPerRow * height, 0);
+	_pathfinding = new AI::PathfindingService(_width, _height);
+	_version = 0;
+	_changes.clear();
+}
+
 void Tilemap::Copy(const Tilemap& copy)
 {
 	_height = copy._height;
 	_width = copy._width;
-	_map = new Tile*[copy._width];
 	_nrOfLoot = copy._nrOfLoot;
-
-	for (int i = 0; i < copy._width; i++)
+	for (int i = 0; i < NR_OF_LAYERS; i++)
 	{
-		_map[i] = new Tile[copy._height];
-
-		for (int j = 0; j < copy._height; j++)
+		_layers[i] = copy._layers[i];
+	}
+	_flags = copy._flags;
+	_nrOfWordsPerRow = copy._nrOfWordsPerRow;
+	_enemyBits = copy._enemyBits;
+	_version = copy._version;
+	_changes = copy._changes;
+
+	delete _pathfinding;
+	_pathfinding = new AI::PathfindingService(_width, _height);
+	for (int i = 0; i < _width; i++)
+	{
+		for (int j = 0; j < _height; j++)
 		{
-			_map[i][j] = Tile(copy._map[i][j]);
+			UpdatePathCost(AI::Vec2D(i, j));
 		}
 	}
 }
 
-Tilemap::~Tilemap()
+/*
+Walls and furniture can't be walked through. Everything else costs the same in the shared pathfinding,
+units add their own costs when refining a path.
+*/
+void Tilemap::UpdatePathCost(AI::Vec2D pos)
 {
-	for (int i = 0; i < _width; i++)
+	if (GetTileFlags(pos) & (WALL_FLAG | FURNITURE_FLAG))
 	{
-		delete[] _map[i];
+		_pathfinding->SetTileCost(pos, -1);
+	}
+	else
+	{
+		_pathfinding->SetTileCost(pos, 1);
+	}
+}
+
+void Tilemap::LogChange(AI::Vec2D pos, int layer, GameObject* oldObject, GameObject* newObject)
+{
+	TileChange change;
+	change._pos = pos;
+	change._layer = layer;
+	change._oldObject = oldObject;
+	change._newObject = newObject;
+	change._oldType = oldObject != nullptr ? oldObject->GetType() : System::NR_OF_TYPES;
+	change._newType = newObject != nullptr ? newObject->GetType() : System::NR_OF_TYPES;
+	_version++;
+	_changes.push_back(change);
+	if ((int)_changes.size() > MAX_NR_OF_LOGGED_CHANGES)
+	{
+		_changes.pop_front();
 	}
-	delete[] _map;
-	_map = nullptr;
+}
+
+/*
+Tiles are stored row by row, so neighbours along x are next to each other in every layer
+*/
+int Tilemap::GetIndex(int x, int z) const
+{
+	return z * _width + x;
+}
+
+void Tilemap::SetEnemyBit(AI::Vec2D pos, bool enemyOnTile)
+{
+	unsigned long long bit = 1ULL << (pos._x % 64);
+	if (enemyOnTile)
+	{
+		_enemyBits[pos._y * _nrOfWordsPerRow + pos._x / 64] |= bit;
+	}
+	else
+	{
+		_enemyBits[pos._y * _nrOfWordsPerRow + pos._x / 64] &= ~bit;
+	}
+}
+
+int Tilemap::GetLayer(System::Type type)
+{
+	switch (type)
+	{
+	case  System::FLOOR:
+	case  System::WALL:
+		return 0;
+	case  System::ENEMY:
+		return 1;
+	case  System::GUARD:
+		return 2;
+	case  System::TRAP:
+	case  System::SPAWN:
+	case  System::CAMERA:
+		return 3;
+	case  System::FURNITURE:
+		return 4;
+	case  System::LOOT:
+		return 5;
+	default:
+		return -1;
+	}
+}
+
+unsigned short Tilemap::GetFlag(System::Type type)
+{
+	switch (type)
+	{
+	case  System::FLOOR:
+		return FLOOR_FLAG;
+	case  System::WALL:
+		return WALL_FLAG;
+	case  System::ENEMY:
+		return ENEMY_FLAG;
+	case  System::GUARD:
+		return GUARD_FLAG;
+	case  System::TRAP:
+		return TRAP_FLAG;
+	case  System::SPAWN:
+		return SPAWN_FLAG;
+	case  System::CAMERA:
+		return CAMERA_FLAG;
+	case  System::FURNITURE:
+		return FURNITURE_FLAG;
+	case  System::LOOT:
+		return LOOT_FLAG;
+	default:
+		return 0;
+	}
+}
+
+Tilemap::~Tilemap()
+{
+	delete _pathfinding;
+	_pathfinding = nullptr;
 }
 
 bool Tilemap::AddObjectToTile(AI::Vec2D pos, GameObject * obj)
@@ -81,45 +193,30 @@ bool Tilemap::AddObjectToTile(AI::Vec2D pos, GameObject * obj)
 	bool result = false;
 	if (IsValid(pos) && obj != nullptr)
 	{
-		int arrayPos = -1;
-		switch (obj->GetType())
+		int layer = GetLayer(obj->GetType());
+		int index = GetIndex(pos._x, pos._y);
+		if (layer != -1 && _layers[layer][index] == nullptr)
 		{
-		case  System::FLOOR:
-		case  System::WALL:
-			arrayPos = 0;
-			break;
-		case  System::ENEMY:
-			arrayPos = 1;
-			break;
-		case  System::GUARD:
-			arrayPos = 2;
-			break;
-		case  System::TRAP:
-		case  System::SPAWN:
-		case  System::CAMERA:
-			arrayPos = 3;
-			break;
-		case  System::LOOT:
-			arrayPos = 5;
-			break;
-		case  System::FURNITURE:
-			arrayPos = 4;
-			break;
-		default:
-			break;
-		}
-
-		if (arrayPos != -1)
-		{
-			if (_map[pos._x][pos._y]._objectsOnTile[arrayPos] == nullptr)
+			_layers[layer][index] = obj;
+		//	obj->SetTilePosition(pos);
+			_flags[index] |= GetFlag(obj->GetType());
+			LogChange(pos, layer, nullptr, obj);
+			result = true;
+			if (obj->GetType() == System::LOOT)
+			{
+				_nrOfLoot++;
+			}
+			else if (obj->GetType() == System::ENEMY)
+			{
+				SetEnemyBit(pos, true);
+			}
+			else if (layer == 0 || layer == 4)
 			{
-				_map[pos._x][pos._y]._objectsOnTile[arrayPos] = obj;
-			//	obj->SetTilePosition(pos);
-				result = true;
-				if (obj->GetType() == System::LOOT)
+				if (obj->GetType() == System::FLOOR && static_cast<Architecture*>(obj)->GetNoPlacementZone())
 				{
-					_nrOfLoot++;
+					_flags[index] |= NO_PLACEMENT_FLAG;
 				}
+				UpdatePathCost(pos);
 			}
 		}
 	}
@@ -136,46 +233,31 @@ bool Tilemap::RemoveObjectFromTile(AI::Vec2D pos, GameObject * obj)
 	bool result = false;
 	if (IsValid(pos) && obj != nullptr)
 	{
-		int arrayPos = -1;
-		switch (obj->GetType())
+		int layer = GetLayer(obj->GetType());
+		int index = GetIndex(pos._x, pos._y);
+		if (layer != -1 && _layers[layer][index] != nullptr && _layers[layer][index]->GetID() == obj->GetID())
 		{
-		case  System::FLOOR:
-		case  System::WALL:
-			arrayPos = 0;
-			break;
-		case  System::ENEMY:
-			arrayPos = 1;
-			break;
-		case  System::GUARD:
-			arrayPos = 2;
-			break;
-		case  System::TRAP:
-		case  System::SPAWN:
-		case  System::CAMERA:
-			arrayPos = 3;
-			break;
-		case  System::FURNITURE:
-			arrayPos = 4;
-			break;
-		case  System::LOOT:
-			arrayPos = 5;
-			break;
-		default:
-			break;
-		}
-		if (arrayPos != -1)
-		{
-			if (_map[pos._x][pos._y]._objectsOnTile[arrayPos] != nullptr && _map[pos._x][pos._y]._objectsOnTile[arrayPos]->GetID() == obj->GetID())
+			_flags[index] &= ~GetFlag(_layers[layer][index]->GetType());
+			LogChange(pos, layer, _layers[layer][index], nullptr);
+			_layers[layer][index] = nullptr;
+			result = true;
+			if (obj->GetType() == System::LOOT)
+			{
+				_nrOfLoot--;
+			}
+			else if (obj->GetType() == System::ENEMY)
+			{
+				SetEnemyBit(pos, false);
+			}
+			else if (layer == 0 || layer == 4)
 			{
-				_map[pos._x][pos._y]._objectsOnTile[arrayPos] = nullptr;
-				result = true;
-				if (obj->GetType() == System::LOOT)
+				if (layer == 0)
 				{
-					_nrOfLoot--;
+					_flags[index] &= ~NO_PLACEMENT_FLAG;
 				}
+				UpdatePathCost(pos);
 			}
 		}
-		
 	}
 	return result;
 }
@@ -185,32 +267,66 @@ bool Tilemap::RemoveObjectFromTile(int x, int z, GameObject * obj)
 	return RemoveObjectFromTile(AI::Vec2D(x, z), obj);
 }
 
+/*
+	Removes the objects but keeps whether the tile is visible or locked
+*/
 void Tilemap::ClearTile(AI::Vec2D pos)
 {
 	if (IsValid(pos))
 	{
-		for (int i = 0; i < Tile::OBJECT_CAPACITY; i++)
+		int index = GetIndex(pos._x, pos._y);
+		for (int i = 0; i < NR_OF_LAYERS; i++)
 		{
-			_map[pos._x][pos._y]._objectsOnTile[i] = nullptr;
+			if (_layers[i][index] != nullptr)
+			{
+				LogChange(pos, i, _layers[i][index], nullptr);
+				_layers[i][index] = nullptr;
+			}
 		}
+		_flags[index] &= VISIBLE_FLAG | LOCKED_FLAG;
+		SetEnemyBit(pos, false);
+		UpdatePathCost(pos);
 	}
 }
 
 void Tilemap::LockTile(AI::Vec2D pos)
 {
-	if (_map[pos._x][pos._y]._objectsOnTile[0] != nullptr)
+	int index = GetIndex(pos._x, pos._y);
+	if (_layers[0][index] != nullptr)
 	{
-		_map[pos._x][pos._y]._lock = true;
-		_map[pos._x][pos._y]._objectsOnTile[0]->SetColorOffset(XMFLOAT3(0.8f, 0, 0));
+		_flags[index] |= LOCKED_FLAG;
+		_layers[0][index]->SetColorOffset(XMFLOAT3(0.8f, 0, 0));
 	}
 }
 
 void Tilemap::UnlockTile(AI::Vec2D pos)
 {
-	if (_map[pos._x][pos._y]._objectsOnTile[0] != nullptr)
+	int index = GetIndex(pos._x, pos._y);
+	if (_layers[0][index] != nullptr)
 	{
-		_map[pos._x][pos._y]._lock = false;
-		_map[pos._x][pos._y]._objectsOnTile[0]->SetColorOffset(XMFLOAT3(0.8f, 0.8f, 0));
+		_flags[index] &= ~LOCKED_FLAG;
+		_layers[0][index]->SetColorOffset(XMFLOAT3(0.8f, 0.8f, 0));
+	}
+}
+
+/*
+	The flag is a copy of the floor's setting, so it has to be changed through the tilemap once the floor is on it
+*/
+void Tilemap::SetNoPlacementZone(AI::Vec2D pos, bool noPlacementZone)
+{
+	if (IsFloorOnTile(pos))
+	{
+		int index = GetIndex(pos._x, pos._y);
+		static_cast<Architecture*>(_layers[0][index])->SetNoPlacementZone(noPlacementZone);
+		LogChange(pos, 0, _layers[0][index], _layers[0][index]);
+		if (noPlacementZone)
+		{
+			_flags[index] |= NO_PLACEMENT_FLAG;
+		}
+		else
+		{
+			_flags[index] &= ~NO_PLACEMENT_FLAG;
+		}
 	}
 }
 
@@ -234,56 +350,113 @@ int Tilemap::GetNrOfLoot() const
 	return _nrOfLoot;
 }
 
-std::vector<GameObject*>* Tilemap::GetAllObjectsOnTile(AI::Vec2D tileCoords) const
+AI::PathfindingService* Tilemap::GetPathfinding() const
 {
-	return &_map[tileCoords._x][tileCoords._y]._objectsOnTile;
+	return _pathfinding;
 }
 
-std::vector<GameObject*>* Tilemap::GetAllObjectsOnTile(int xCoord, int yCoord) const
+unsigned int Tilemap::GetVersion() const
 {
-	return &_map[xCoord][yCoord]._objectsOnTile;
+	return _version;
 }
 
-GameObject * Tilemap::GetObjectOnTile(AI::Vec2D pos, System::Type type) const
+bool Tilemap::GetChanges(unsigned int sinceVersion, std::vector<TileChange>& changes) const
 {
-	GameObject* result = nullptr;
-	if (IsValid(pos))
+	unsigned int nrOfChanges = _version - sinceVersion;
+	if (nrOfChanges > _changes.size())
+	{
+		return false;
+	}
+	changes.insert(changes.end(), _changes.end() - nrOfChanges, _changes.end());
+	return true;
+}
+
+/*
+Every changed tile starts as a region of its own. Regions that overlap or are within DIRTY_REGION_MERGE_DISTANCE
+of each other are merged, over and over until no two are that close, since a merged region can reach new ones.
+*/
+bool Tilemap::GetDirtyRegions(unsigned int sinceVersion, std::vector<DirtyRegion>& regions) const
+{
+	unsigned int nrOfChanges = _version - sinceVersion;
+	if (nrOfChanges > _changes.size())
 	{
-		switch (type)
+		return false;
+	}
+	std::vector<DirtyRegion> merged;
+	for (std::deque<TileChange>::const_iterator i = _changes.end() - nrOfChanges; i != _changes.end(); i++)
+	{
+		DirtyRegion region;
+		region._min = i->_pos;
+		region._max = i->_pos;
+		bool growing = true;
+		while (growing)
 		{
-		case  System::FLOOR:
-		case  System::WALL:
-			result = _map[pos._x][pos._y]._objectsOnTile[0];
-			break;
-		case  System::ENEMY:
-			result = _map[pos._x][pos._y]._objectsOnTile[1];
-			break;
-		case  System::GUARD:
-			result = _map[pos._x][pos._y]._objectsOnTile[2];
-			break;
-		case  System::SPAWN:
-		case  System::TRAP:
-		case  System::CAMERA:
-			result = _map[pos._x][pos._y]._objectsOnTile[3];
-			break;
-		case  System::FURNITURE:
-			result = _map[pos._x][pos._y]._objectsOnTile[4];
-			break;
-		case  System::LOOT:
-			result = _map[pos._x][pos._y]._objectsOnTile[5];
-			break;
-		default:
-			break;
+			growing = false;
+			for (unsigned int j = 0; j < merged.size(); j++)
+			{
+				if (merged[j]._min._x - DIRTY_REGION_MERGE_DISTANCE <= region._max._x && region._min._x <= merged[j]._max._x + DIRTY_REGION_MERGE_DISTANCE &&
+					merged[j]._min._y - DIRTY_REGION_MERGE_DISTANCE <= region._max._y && region._min._y <= merged[j]._max._y + DIRTY_REGION_MERGE_DISTANCE)
+				{
+					region._min._x = merged[j]._min._x < region._min._x ? merged[j]._min._x : region._min._x;
+					region._min._y = merged[j]._min._y < region._min._y ? merged[j]._min._y : region._min._y;
+					region._max._x = merged[j]._max._x > region._max._x ? merged[j]._max._x : region._max._x;
+					region._max._y = merged[j]._max._y > region._max._y ? merged[j]._max._y : region._max._y;
+					merged[j] = merged.back();
+					merged.pop_back();
+					growing = true;
+					break;
+				}
+			}
 		}
+		merged.push_back(region);
 	}
-	if (result!= nullptr && result->GetType() == type)
+	regions.insert(regions.end(), merged.begin(), merged.end());
+	return true;
+}
+
+std::vector<GameObject*> Tilemap::GetAllObjectsOnTile(AI::Vec2D tileCoords) const
+{
+	return GetAllObjectsOnTile(tileCoords._x, tileCoords._y);
+}
+
+std::vector<GameObject*> Tilemap::GetAllObjectsOnTile(int xCoord, int yCoord) const
+{
+	std::vector<GameObject*> objects(NR_OF_LAYERS);
+	int index = GetIndex(xCoord, yCoord);
+	for (int i = 0; i < NR_OF_LAYERS; i++)
 	{
-		return result;
+		objects[i] = _layers[i][index];
 	}
-	else
+	return objects;
+}
+
+unsigned short Tilemap::GetTileFlags(AI::Vec2D pos) const
+{
+	return GetTileFlags(pos._x, pos._y);
+}
+
+unsigned short Tilemap::GetTileFlags(int x, int z) const
+{
+	return IsValid(x, z) ? _flags[GetIndex(x, z)] : 0;
+}
+
+const unsigned long long* Tilemap::GetEnemyBits() const
+{
+	return _enemyBits.data();
+}
+
+int Tilemap::GetNrOfWordsPerRow() const
+{
+	return _nrOfWordsPerRow;
+}
+
+GameObject * Tilemap::GetObjectOnTile(AI::Vec2D pos, System::Type type) const
+{
+	if (GetTileFlags(pos) & GetFlag(type))
 	{
-		return nullptr;
+		return _layers[GetLayer(type)][GetIndex(pos._x, pos._y)];
 	}
+	return nullptr;
 }
 
 GameObject * Tilemap::GetObjectOnTile(int x, int z, System::Type type) const
@@ -303,22 +476,22 @@ bool Tilemap::IsValid(int x, int z) const
 
 bool Tilemap::IsPlaceable(int x, int z, System::Type type) const
 {
+	unsigned short flags = GetTileFlags(x, z);
 	bool placeable = false;
-	if (IsValid(x, z) && !IsWallOnTile(x, z))
+	if (IsValid(x, z) && !(flags & WALL_FLAG))
 	{
 		if (type == System::FLOOR || type == System::WALL)
 		{
-			placeable = !_map[x][z]._objectsOnTile[0];
-		}
-		else if (type == System::LOOT ||type == System::CAMERA)					//Special case, because loot and cameras can be on furniture
-		{
-			placeable = IsFloorOnTile(x, z) && !_map[x][z]._objectsOnTile[1] && !_map[x][z]._objectsOnTile[2] && !_map[x][z]._objectsOnTile[3] &&
-				 !_map[x][z]._objectsOnTile[5] && !IsTileNoPlacementZone(x, z);
+			placeable = !(flags & FLOOR_FLAG);
 		}
 		else
 		{
-			placeable = IsFloorOnTile(x, z) && !_map[x][z]._objectsOnTile[1] && !_map[x][z]._objectsOnTile[2] && !_map[x][z]._objectsOnTile[3] && 
-						!_map[x][z]._objectsOnTile[4] && !_map[x][z]._objectsOnTile[5] && !IsTileNoPlacementZone(x, z);
+			unsigned short blocking = ENEMY_FLAG | GUARD_FLAG | TRAP_FLAG | SPAWN_FLAG | CAMERA_FLAG | LOOT_FLAG | NO_PLACEMENT_FLAG;
+			if (type != System::LOOT && type != System::CAMERA)						//Special case, because loot and cameras can be on furniture
+			{
+				blocking |= FURNITURE_FLAG;
+			}
+			placeable = (flags & FLOOR_FLAG) && !(flags & blocking);
 		}
 	}
 
@@ -332,7 +505,7 @@ bool Tilemap::IsPlaceable(AI::Vec2D pos, System::Type type) const
 
 bool Tilemap::IsArchitectureOnTile(int x, int z) const
 {
-	return IsValid(x, z) && _map[x][z]._objectsOnTile[0] != nullptr;
+	return (GetTileFlags(x, z) & (WALL_FLAG | FLOOR_FLAG)) != 0;
 }
 
 bool Tilemap::IsArchitectureOnTile(AI::Vec2D pos) const
@@ -342,7 +515,7 @@ bool Tilemap::IsArchitectureOnTile(AI::Vec2D pos) const
 
 bool Tilemap::IsWallOnTile(int x, int z) const
 {
-	return IsArchitectureOnTile(x, z) && _map[x][z]._objectsOnTile[0]->GetType() == System::WALL;
+	return (GetTileFlags(x, z) & WALL_FLAG) != 0;
 }
 
 bool Tilemap::IsWallOnTile(AI::Vec2D pos) const
@@ -352,7 +525,7 @@ bool Tilemap::IsWallOnTile(AI::Vec2D pos) const
 
 bool Tilemap::IsFurnitureOnTile(int x, int z) const
 {
-	return IsValid(x, z) && _map[x][z]._objectsOnTile[4] != nullptr;
+	return (GetTileFlags(x, z) & FURNITURE_FLAG) != 0;
 }
 
 bool Tilemap::IsFurnitureOnTile(AI::Vec2D pos) const
@@ -362,7 +535,7 @@ bool Tilemap::IsFurnitureOnTile(AI::Vec2D pos) const
 
 bool Tilemap::IsFloorOnTile(int x, int z) const
 {
-	return IsArchitectureOnTile(x, z) && _map[x][z]._objectsOnTile[0]->GetType() == System::FLOOR;
+	return (GetTileFlags(x, z) & FLOOR_FLAG) != 0;
 }
 
 bool Tilemap::IsFloorOnTile(AI::Vec2D pos) const
@@ -372,19 +545,8 @@ bool Tilemap::IsFloorOnTile(AI::Vec2D pos) const
 
 int Tilemap::UnitsOnTile(int x, int z) const
 {
-	int result = 0;
-	if (IsValid(x, z))
-	{
-		if (_map[x][z]._objectsOnTile[1] != nullptr)
-		{
-			result++;
-		}
-		if (_map[x][z]._objectsOnTile[2] != nullptr)
-		{
-			result++;
-		}
-	}
-	return result;
+	unsigned short flags = GetTileFlags(x, z);
+	return ((flags & ENEMY_FLAG) != 0) + ((flags & GUARD_FLAG) != 0);
 }
 
 int Tilemap::UnitsOnTile(AI::Vec2D pos) const
@@ -394,7 +556,7 @@ int Tilemap::UnitsOnTile(AI::Vec2D pos) const
 
 bool Tilemap::IsGuardOnTile(int x, int z) const
 {
-	return  IsValid(x, z) && _map[x][z]._objectsOnTile[2] != nullptr;
+	return (GetTileFlags(x, z) & GUARD_FLAG) != 0;
 }
 
 bool Tilemap::IsGuardOnTile(AI::Vec2D pos) const
@@ -404,7 +566,7 @@ bool Tilemap::IsGuardOnTile(AI::Vec2D pos) const
 
 bool Tilemap::IsEnemyOnTile(int x, int z) const
 {
-	return  IsValid(x, z) && _map[x][z]._objectsOnTile[1] != nullptr;
+	return (GetTileFlags(x, z) & ENEMY_FLAG) != 0;
 }
 
 bool Tilemap::IsEnemyOnTile(AI::Vec2D pos) const
@@ -414,14 +576,7 @@ bool Tilemap::IsEnemyOnTile(AI::Vec2D pos) const
 
 bool Tilemap::IsTrapOnTile(int x, int z) const
 {
-	if (!IsValid(x, z) || _map[x][z]._objectsOnTile[3] == nullptr)
-	{
-		return false;
-	}
-	else
-	{
-		return  _map[x][z]._objectsOnTile[3]->GetType() == System::TRAP;
-	}
+	return (GetTileFlags(x, z) & TRAP_FLAG) != 0;
 }
 
 bool Tilemap::IsTrapOnTile(AI::Vec2D pos) const
@@ -431,7 +586,7 @@ bool Tilemap::IsTrapOnTile(AI::Vec2D pos) const
 
 bool Tilemap::IsObjectiveOnTile(int x, int z) const
 {
-	return IsValid(x, z) && _map[x][z]._objectsOnTile[5] != nullptr;
+	return (GetTileFlags(x, z) & LOOT_FLAG) != 0;
 }
 
 bool Tilemap::IsObjectiveOnTile(AI::Vec2D pos) const
@@ -441,14 +596,7 @@ bool Tilemap::IsObjectiveOnTile(AI::Vec2D pos) const
 
 bool Tilemap::IsSpawnOnTile(int x, int z) const
 {
-	if (!IsValid(x, z) || _map[x][z]._objectsOnTile[3] == nullptr)
-	{
-		return false;
-	}
-	else
-	{
-		return  _map[x][z]._objectsOnTile[3]->GetType() == System::SPAWN;
-	}
+	return (GetTileFlags(x, z) & SPAWN_FLAG) != 0;
 }
 
 bool Tilemap::IsSpawnOnTile(AI::Vec2D pos) const
@@ -458,17 +606,7 @@ bool Tilemap::IsSpawnOnTile(AI::Vec2D pos) const
 
 bool Tilemap::IsTypeOnTile(int x, int z, System::Type type) const
 {
-	if (IsValid(x, z))
-	{
-		for (int i = 0; i < Tile::OBJECT_CAPACITY; i++)
-		{
-			if (_map[x][z]._objectsOnTile[i] != nullptr && _map[x][z]._objectsOnTile[i]->GetType() == type)
-			{
-				return true;
-			}
-		}
-	}
-	return false;
+	return (GetTileFlags(x, z) & GetFlag(type)) != 0;
 }
 
 bool Tilemap::IsTypeOnTile(AI::Vec2D pos, System::Type type) const
@@ -478,7 +616,7 @@ bool Tilemap::IsTypeOnTile(AI::Vec2D pos, System::Type type) const
 
 bool Tilemap::IsTileVisible(int x, int z) const
 {
-	return _map[x][z]._isVisible;
+	return (GetTileFlags(x, z) & VISIBLE_FLAG) != 0;
 }
 
 bool Tilemap::IsTileVisible(AI::Vec2D pos) const
@@ -492,16 +630,7 @@ bool Tilemap::IsTileVisible(AI::Vec2D pos) const
 
 bool Tilemap::IsTileEmpty(int x, int z) const
 {
-	bool empty = true;
-	for (int i = 0; i < Tile::OBJECT_CAPACITY; i++)
-	{
-		if (_map[x][z]._objectsOnTile[i] != nullptr)
-		{
-			empty = false;
-			break;
-		}
-	}
-	return empty;
+	return (GetTileFlags(x, z) & OBJECT_FLAGS) == 0;
 }
 
 bool Tilemap::IsTileEmpty(AI::Vec2D pos) const
@@ -511,7 +640,7 @@ bool Tilemap::IsTileEmpty(AI::Vec2D pos) const
 
 bool Tilemap::IsTileNoPlacementZone(int x, int z) const
 {
-	return IsFloorOnTile(x, z) && static_cast<Architecture*>(_map[x][z]._objectsOnTile[0])->GetNoPlacementZone();
+	return (GetTileFlags(x, z) & NO_PLACEMENT_FLAG) != 0;
 }
 
 bool Tilemap::IsTileNoPlacementZone(AI::Vec2D pos) const
@@ -3,47 +3,82 @@
 
 #pragma once
 
+#include <deque>
 #include "Architecture.h"
+#include "PathfindingService.h"
 
 class Tilemap
 {
-private:
-	struct Tile
+public:
+	/*
+		What is on a tile, packed into one mask per tile so the type queries never have to touch the objects
+	*/
+	enum TileFlag
+	{
+		WALL_FLAG = 1 << 0,
+		FLOOR_FLAG = 1 << 1,
+		TRAP_FLAG = 1 << 2,
+		GUARD_FLAG = 1 << 3,
+		ENEMY_FLAG = 1 << 4,
+		LOOT_FLAG = 1 << 5,
+		SPAWN_FLAG = 1 << 6,
+		NO_PLACEMENT_FLAG = 1 << 7,				//Set on floors marked as no placement zones
+		FURNITURE_FLAG = 1 << 8,
+		CAMERA_FLAG = 1 << 9,
+		VISIBLE_FLAG = 1 << 10,
+		LOCKED_FLAG = 1 << 11,
+		OBJECT_FLAGS = WALL_FLAG | FLOOR_FLAG | TRAP_FLAG | GUARD_FLAG | ENEMY_FLAG | LOOT_FLAG | SPAWN_FLAG | FURNITURE_FLAG | CAMERA_FLAG
+	};
+
+	/*
+		One entry of the change journal. Old and new object are the same floor when only its no placement zone changed.
+		Removed objects may have been deleted since, so check the types instead of dereferencing them
+	*/
+	struct TileChange
 	{
-		static const int OBJECT_CAPACITY = 6;
-		std::vector<GameObject*> _objectsOnTile;					//0 = floor or wall, 1 = enemy, 2 = guard, 3 = trap or spawnpoint, 4 = furniture, 5 = thief objectives 
-		bool _isVisible;
-		bool _lock;
-		Tile()
-		{
-			_objectsOnTile.resize(OBJECT_CAPACITY);
-			for (int i = 0; i < OBJECT_CAPACITY; i++)
-			{
-				_objectsOnTile[i] = nullptr;
-			}
-			_isVisible = false;
-			_lock = false;
-		}
-		~Tile(){}
-
-		Tile& operator=(const Tile& comp)
-		{
-			for (int i = 0; i < OBJECT_CAPACITY; i++)
-			{
-				_objectsOnTile[i] = comp._objectsOnTile[i];
-			}
-			return *this;
-		}
+		AI::Vec2D _pos;
+		int _layer;
+		GameObject* _oldObject;					//nullptr if the object was added to an empty slot
+		GameObject* _newObject;					//nullptr if the object was removed
+		System::Type _oldType;					//NR_OF_TYPES if there was no object
+		System::Type _newType;					//NR_OF_TYPES if there is no object
 	};
+
+	/*
+		Tiles from _min to _max, both included
+	*/
+	struct DirtyRegion
+	{
+		AI::Vec2D _min;
+		AI::Vec2D _max;
+	};
+private:
+	static const int NR_OF_LAYERS = 6;
 	int _height;
 	int _width;
 
 	int _nrOfLoot;			//Note: This is the amount of loot on the tilemap. Does not count held objects.
-	Tile** _map;
+	std::vector<GameObject*> _layers[NR_OF_LAYERS];	//One array per layer, indexed by GetIndex. 0 = floor or wall, 1 = enemy, 2 = guard, 3 = trap, spawnpoint or camera, 4 = furniture, 5 = thief objectives
+	std::vector<unsigned short> _flags;			//TileFlags of every tile, indexed by GetIndex
+	int _nrOfWordsPerRow;
+	std::vector<unsigned long long> _enemyBits;	//One bit per tile with an enemy on it, every row starting on a new word
+	AI::PathfindingService* _pathfinding;	//Pathfinding shared by all units. Kept up to date with walls and furniture
+	unsigned int _version;					//Incremented on every change to the objects on the tilemap
+	std::deque<TileChange> _changes;		//The latest changes, one per version with the newest at the back
 
 private:
+	void Create(int width, int height);
 	void Copy(const Tilemap& copy);
+	void UpdatePathCost(AI::Vec2D pos);
+	void LogChange(AI::Vec2D pos, int layer, GameObject* oldObject, GameObject* newObject);
+	int GetIndex(int x, int z) const;
+	void SetEnemyBit(AI::Vec2D pos, bool enemyOnTile);
+	static int GetLayer(System::Type type);					//-1 for types not kept on the tilemap
+	static unsigned short GetFlag(System::Type type);		//0 for types not kept on the tilemap
 public:
+	static const int MAX_NR_OF_LOGGED_CHANGES = 1024;
+	static const int DIRTY_REGION_MERGE_DISTANCE = 2;		//Regions closer than this many tiles are merged into one
+
 	Tilemap();
 	Tilemap(AI::Vec2D size);
 	Tilemap(const Tilemap& copy);
@@ -60,17 +95,34 @@ public:
 
 	void LockTile(AI::Vec2D pos);
 	void UnlockTile(AI::Vec2D pos);
+	void SetNoPlacementZone(AI::Vec2D pos, bool noPlacementZone);	//Changes the floor of the tile, if there is one
 
 	int GetNrOfTiles() const;
 	int GetHeight() const;
 	int GetWidth() const;
 	int GetNrOfLoot()const;
+	AI::PathfindingService* GetPathfinding()const;			//Searching changes the service, so it is handed out as non-const
+	unsigned int GetVersion() const;
+
+	/*
+		Appends the changes made after sinceVersion, oldest first. Returns false if some of them are no longer logged,
+		then the caller has to treat the whole tilemap as changed.
+	*/
+	bool GetChanges(unsigned int sinceVersion, std::vector<TileChange>& changes) const;
+	/*
+		Same as GetChanges, but merges the changed tiles into rectangles. Tiles close to each other end up in the same one
+	*/
+	bool GetDirtyRegions(unsigned int sinceVersion, std::vector<DirtyRegion>& regions) const;
 
 	GameObject* GetObjectOnTile(AI::Vec2D pos, System::Type type) const;
 	GameObject* GetObjectOnTile(int x, int z, System::Type type) const;
 
-	std::vector<GameObject*>* GetAllObjectsOnTile(AI::Vec2D tileCoords) const;
-	std::vector<GameObject*>* GetAllObjectsOnTile(int xCoord, int yCoord) const;
+	std::vector<GameObject*> GetAllObjectsOnTile(AI::Vec2D tileCoords) const;		//One slot per layer, nullptr if empty
+	std::vector<GameObject*> GetAllObjectsOnTile(int xCoord, int yCoord) const;
+	unsigned short GetTileFlags(AI::Vec2D pos) const;							//0 outside the map
+	unsigned short GetTileFlags(int x, int z) const;
+	const unsigned long long* GetEnemyBits() const;						//Laid out like VisibilityGrid, for finding the enemies in view without looking at every tile
+	int GetNrOfWordsPerRow() const;
 
 	bool IsValid(AI::Vec2D pos) const;
 	bool IsValid(int x, int z) const;
@@ -0,0 +1,202 @@
+#include "TransformStore.h"
+#include <cstring>
+
+TransformStore::TransformStore()
+{
+	_matrices = nullptr;
+	_capacity = 0;
+	_interpolation = 1.0f;
+}
+
+TransformStore::~TransformStore()
+{
+	if (_matrices != nullptr)
+	{
+		_mm_free(_matrices);
+	}
+}
+
+void TransformStore::SetBit(std::vector<unsigned int>& bits, unsigned int slot, bool set)
+{
+	if (set)
+	{
+		bits[slot / 32] |= 1u << (slot % 32);
+	}
+	else
+	{
+		bits[slot / 32] &= ~(1u << (slot % 32));
+	}
+}
+
+bool TransformStore::GetBit(const std::vector<unsigned int>& bits, unsigned int slot)
+{
+	return ((bits[slot / 32] >> (slot % 32)) & 1u) != 0;
+}
+
+/*
+Takes the shortest way around, so a unit turning from 3/2 pi to 0 does not spin the long way
+*/
+float TransformStore::LerpAngle(float from, float to, float amount)
+{
+	float difference = to - from;
+	while (difference > DirectX::XM_PI)
+	{
+		difference -= DirectX::XM_2PI;
+	}
+	while (difference < -DirectX::XM_PI)
+	{
+		difference += DirectX::XM_2PI;
+	}
+	return from + difference * amount;
+}
+
+/*
+Scale * rotation * translation, without the two matrix multiplications. Scaling first only scales the rows
+of the rotation, and translating last only replaces the bottom row
+*/
+void TransformStore::RebuildMatrix(unsigned int slot)
+{
+	DirectX::XMFLOAT3 position = _positions[slot];
+	DirectX::XMFLOAT3 rotation = _rotations[slot];
+	DirectX::XMFLOAT3 scale = _scales[slot];
+	if (GetBit(_movingBits, slot) && _interpolation < 1.0f)
+	{
+		const DirectX::XMFLOAT3& previousPosition = _previousPositions[slot];
+		const DirectX::XMFLOAT3& previousRotation = _previousRotations[slot];
+		const DirectX::XMFLOAT3& previousScale = _previousScales[slot];
+		position.x = previousPosition.x + (position.x - previousPosition.x) * _interpolation;
+		position.y = previousPosition.y + (position.y - previousPosition.y) * _interpolation;
+		position.z = previousPosition.z + (position.z - previousPosition.z) * _interpolation;
+		rotation.x = LerpAngle(previousRotation.x, rotation.x, _interpolation);
+		rotation.y = LerpAngle(previousRotation.y, rotation.y, _interpolation);
+		rotation.z = LerpAngle(previousRotation.z, rotation.z, _interpolation);
+		scale.x = previousScale.x + (scale.x - previousScale.x) * _interpolation;
+		scale.y = previousScale.y + (scale.y - previousScale.y) * _interpolation;
+		scale.z = previousScale.z + (scale.z - previousScale.z) * _interpolation;
+	}
+
+	DirectX::XMMATRIX rotationMatrix = DirectX::XMMatrixRotationRollPitchYaw(rotation.x, rotation.y, rotation.z);
+	DirectX::XMMATRIX& matrix = _matrices[slot];
+	matrix.r[0] = DirectX::XMVectorScale(rotationMatrix.r[0], scale.x);
+	matrix.r[1] = DirectX::XMVectorScale(rotationMatrix.r[1], scale.y);
+	matrix.r[2] = DirectX::XMVectorScale(rotationMatrix.r[2], scale.z);
+	matrix.r[3] = DirectX::XMVectorSet(position.x, position.y, position.z, 1.0f);
+	SetBit(_dirtyBits, slot, false);
+}
+
+unsigned int TransformStore::Add(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& rotation, const DirectX::XMFLOAT3& scale)
+{
+	unsigned int slot;
+	if (!_freeSlots.empty())
+	{
+		slot = _freeSlots.back();
+		_freeSlots.pop_back();
+	}
+	else
+	{
+		slot = _positions.size();
+		_positions.push_back(position);
+		_rotations.push_back(rotation);
+		_scales.push_back(scale);
+		_previousPositions.push_back(position);
+		_previousRotations.push_back(rotation);
+		_previousScales.push_back(scale);
+		_dirtyBits.resize((slot + 32) / 32, 0);
+		_movingBits.resize((slot + 32) / 32, 0);
+
+		if (slot == _capacity)
+		{
+			_capacity = _capacity == 0 ? 64 : _capacity * 2;
+			DirectX::XMMATRIX* matrices = (DirectX::XMMATRIX*)_mm_malloc(_capacity * sizeof(DirectX::XMMATRIX), 16);
+			if (_matrices != nullptr)
+			{
+				memcpy(matrices, _matrices, slot * sizeof(DirectX::XMMATRIX));
+				_mm_free(_matrices);
+			}
+			_matrices = matrices;
+		}
+	}
+	//A new object appears where it is placed instead of moving there from what the slot held before
+	_positions[slot] = _previousPositions[slot] = position;
+	_rotations[slot] = _previousRotations[slot] = rotation;
+	_scales[slot] = _previousScales[slot] = scale;
+	SetBit(_movingBits, slot, false);
+	SetBit(_dirtyBits, slot, true);
+	return slot;
+}
+
+void TransformStore::Remove(unsigned int slot)
+{
+	SetBit(_dirtyBits, slot, false);
+	SetBit(_movingBits, slot, false);
+	_freeSlots.push_back(slot);
+}
+
+void TransformStore::Set(unsigned int slot, const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& rotation, const DirectX::XMFLOAT3& scale)
+{
+	//Only the first move of a tick saves the transform, the rest of the tick moves from the same place
+	if (!GetBit(_movingBits, slot))
+	{
+		_previousPositions[slot] = _positions[slot];
+		_previousRotations[slot] = _rotations[slot];
+		_previousScales[slot] = _scales[slot];
+		SetBit(_movingBits, slot, true);
+	}
+	_positions[slot] = position;
+	_rotations[slot] = rotation;
+	_scales[slot] = scale;
+	SetBit(_dirtyBits, slot, true);
+}
+
+DirectX::XMMATRIX* TransformStore::GetMatrix(unsigned int slot)
+{
+	if (GetBit(_dirtyBits, slot))
+	{
+		RebuildMatrix(slot);
+	}
+	return &_matrices[slot];
+}
+
+/*
+The slots that moved during the last tick have their transform saved and one more rebuild, so that they come
+to rest where the tick left them if they do not move again
+*/
+void TransformStore::BeginTick()
+{
+	for (unsigned int i = 0; i < _movingBits.size(); i++)
+	{
+		unsigned int bits = _movingBits[i];
+		for (unsigned int j = 0; bits != 0; j++, bits >>= 1)
+		{
+			if (bits & 1u)
+			{
+				unsigned int slot = i * 32 + j;
+				_previousPositions[slot] = _positions[slot];
+				_previousRotations[slot] = _rotations[slot];
+				_previousScales[slot] = _scales[slot];
+			}
+		}
+		_dirtyBits[i] |= _movingBits[i];
+		_movingBits[i] = 0;
+	}
+}
+
+/*
+Whole words of clean slots are skipped, so only the objects that moved since the last frame are visited.
+The moving slots are rebuilt every frame, since the interpolation changes even when they do not
+*/
+void TransformStore::RebuildMatrices(float interpolation)
+{
+	_interpolation = interpolation;
+	for (unsigned int i = 0; i < _dirtyBits.size(); i++)
+	{
+		unsigned int bits = _dirtyBits[i] | _movingBits[i];
+		for (unsigned int j = 0; bits != 0; j++, bits >>= 1)
+		{
+			if (bits & 1u)
+			{
+				RebuildMatrix(i * 32 + j);
+			}
+		}
+	}
+}
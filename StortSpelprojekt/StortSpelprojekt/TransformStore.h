@@ -0,0 +1,52 @@
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+
+/*
+Position, rotation and scale of every game object, one array per component, and the world matrices built from them.
+A game object owns one slot and marks it as dirty when it moves. The matrices of all dirty slots are rebuilt together
+once per frame, so objects that never move, like floors, walls and furniture, cost nothing after they are placed.
+
+The game logic runs in fixed ticks, so the transform a slot had when the current tick began is kept as well. The
+slots that moved during the tick are rebuilt every frame, interpolated between the two by how far the frame has
+come towards the next tick.
+*/
+class TransformStore
+{
+private:
+	std::vector<DirectX::XMFLOAT3> _positions;
+	std::vector<DirectX::XMFLOAT3> _rotations;
+	std::vector<DirectX::XMFLOAT3> _scales;
+	std::vector<DirectX::XMFLOAT3> _previousPositions;	//The transforms when the current tick began
+	std::vector<DirectX::XMFLOAT3> _previousRotations;
+	std::vector<DirectX::XMFLOAT3> _previousScales;
+	DirectX::XMMATRIX* _matrices;				//Allocated with _mm_malloc to keep the matrices 16 byte aligned
+	unsigned int _capacity;						//Number of matrices _matrices has room for
+	std::vector<unsigned int> _dirtyBits;		//One bit per slot, set while the matrix of the slot is outdated
+	std::vector<unsigned int> _movingBits;		//One bit per slot, set if the slot has moved during the current tick
+	float _interpolation;						//0 is the transform when the tick began, 1 the current one
+	std::vector<unsigned int> _freeSlots;		//Slots of removed objects, reused before the arrays grow
+
+	static void SetBit(std::vector<unsigned int>& bits, unsigned int slot, bool set);
+	static bool GetBit(const std::vector<unsigned int>& bits, unsigned int slot);
+	static float LerpAngle(float from, float to, float amount);
+	void RebuildMatrix(unsigned int slot);
+
+	TransformStore(const TransformStore&) = delete;
+	TransformStore& operator=(const TransformStore&) = delete;
+public:
+	TransformStore();
+	~TransformStore();
+
+	unsigned int Add(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& rotation, const DirectX::XMFLOAT3& scale);
+	void Remove(unsigned int slot);
+	void Set(unsigned int slot, const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& rotation, const DirectX::XMFLOAT3& scale);
+
+	/*
+	Returns the world matrix of the slot, rebuilding it first if it is dirty.
+	The pointer is valid until the next Add
+	*/
+	DirectX::XMMATRIX* GetMatrix(unsigned int slot);
+	void BeginTick();								//Makes the current transforms the ones interpolated from
+	void RebuildMatrices(float interpolation = 1.0f);	//Rebuilds the matrices of all dirty and moving slots
+};
@@ -0,0 +1,89 @@
+#include "VisibilityGrid.h"
+
+VisibilityGrid::VisibilityGrid()
+{
+	_width = 0;
+	_height = 0;
+	_nrOfWordsPerRow = 0;
+}
+
+VisibilityGrid::~VisibilityGrid()
+{}
+
+void VisibilityGrid::Resize(int width, int height)
+{
+	_width = width;
+	_height = height;
+	_nrOfWordsPerRow = (width + 63) / 64;
+	for (int i = 0; i < NR_OF_TEAMS; i++)
+	{
+		_bits[i].assign(_nrOfWordsPerRow * height, 0);
+	}
+}
+
+void VisibilityGrid::Clear()
+{
+	for (int i = 0; i < NR_OF_TEAMS; i++)
+	{
+		_bits[i].assign(_bits[i].size(), 0);
+	}
+}
+
+/*
+	Every row of the cone is shifted into place and OR:ed into at most two words.
+	The cone only holds tiles on the tilemap, so nothing is shifted outside the grid.
+*/
+void VisibilityGrid::AddCone(Team team, const VisionCone* cone)
+{
+	int radius = cone->GetRadius();
+	AI::Vec2D pos = cone->GetPosition();
+	for (int row = 0; row < 2 * radius + 1; row++)
+	{
+		unsigned long long mask = cone->GetRowMask(row);
+		int z = pos._y - radius + row;
+		if (mask == 0 || z < 0 || z >= _height)
+		{
+			continue;
+		}
+		int x = pos._x - radius;
+		if (x < 0)
+		{
+			mask >>= -x;
+			x = 0;
+		}
+		unsigned long long* word = &_bits[team][z * _nrOfWordsPerRow + x / 64];
+		word[0] |= mask << (x % 64);
+		if (x % 64 != 0 && x / 64 + 1 < _nrOfWordsPerRow)
+		{
+			word[1] |= mask >> (64 - x % 64);
+		}
+	}
+}
+
+bool VisibilityGrid::IsTileVisible(Team team, AI::Vec2D pos) const
+{
+	if (pos._x < 0 || pos._x >= _width || pos._y < 0 || pos._y >= _height)
+	{
+		return false;
+	}
+	return ((_bits[team][pos._y * _nrOfWordsPerRow + pos._x / 64] >> (pos._x % 64)) & 1) != 0;
+}
+
+void VisibilityGrid::GetVisibleEnemies(Team team, const Tilemap* tilemap, std::vector<AI::Vec2D>& tiles) const
+{
+	const unsigned long long* enemyBits = tilemap->GetEnemyBits();
+	for (int z = 0; z < _height; z++)
+	{
+		for (int w = 0; w < _nrOfWordsPerRow; w++)
+		{
+			unsigned long long seen = _bits[team][z * _nrOfWordsPerRow + w] & enemyBits[z * _nrOfWordsPerRow + w];
+			for (int x = w * 64; seen != 0; x++, seen >>= 1)
+			{
+				if (seen & 1)
+				{
+					tiles.push_back(AI::Vec2D(x, z));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include "VisionCone.h"
+
+/*
+	What each team sees, one bit per tile. Rows start on a new word, the same way as Tilemap::GetEnemyBits,
+	so the two can be combined a word at a time.
+	Rebuilt by ObjectHandler every update from the vision cones of the units and cameras.
+*/
+class VisibilityGrid
+{
+public:
+	enum Team { GUARD_TEAM, ENEMY_TEAM, NR_OF_TEAMS };		//Cameras are on the guards' team
+private:
+	int _width;
+	int _height;
+	int _nrOfWordsPerRow;
+	std::vector<unsigned long long> _bits[NR_OF_TEAMS];
+public:
+	VisibilityGrid();
+	~VisibilityGrid();
+
+	void Resize(int width, int height);							//Also clears the grid
+	void Clear();
+	void AddCone(Team team, const VisionCone* cone);
+
+	bool IsTileVisible(Team team, AI::Vec2D pos) const;
+	void GetVisibleEnemies(Team team, const Tilemap* tilemap, std::vector<AI::Vec2D>& tiles) const;	//Appends the tiles with enemies the team can see
+};
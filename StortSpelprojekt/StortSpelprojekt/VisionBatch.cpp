@@ -0,0 +1,103 @@
+#include "VisionBatch.h"
+
+/*
+	Takes cones until there are none left. The calling thread takes part as well
+*/
+void VisionBatch::UpdateCones()
+{
+	int i = _nextCone++;
+	while (i < (int)_cones->size())
+	{
+		(*_cones)[i]->Update();
+		i = _nextCone++;
+	}
+}
+
+/*
+	Waits for batches until the batch is destroyed
+*/
+void VisionBatch::RunWorker()
+{
+	unsigned int nrOfBatchesDone = 0;
+	std::unique_lock<std::mutex> lock(_lock);
+	while (true)
+	{
+		_batchStarted.wait(lock, [&]() { return _stopping || _nrOfBatches != nrOfBatchesDone; });
+		if (_stopping)
+		{
+			return;
+		}
+		nrOfBatchesDone = _nrOfBatches;
+		lock.unlock();
+
+		UpdateCones();
+
+		lock.lock();
+		if (--_nrOfBusyWorkers == 0)
+		{
+			_batchDone.notify_one();
+		}
+	}
+}
+
+VisionBatch::VisionBatch()
+{
+	_cones = nullptr;
+	_nextCone = 0;
+	_nrOfBatches = 0;
+	_nrOfBusyWorkers = 0;
+	_stopping = false;
+}
+
+VisionBatch::~VisionBatch()
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_stopping = true;
+	}
+	_batchStarted.notify_all();
+	for (unsigned int i = 0; i < _workers.size(); i++)
+	{
+		_workers[i].join();
+	}
+}
+
+void VisionBatch::Update(std::vector<VisionCone*>& cones)
+{
+	if ((int)cones.size() < 2 * MIN_NR_OF_CONES_PER_THREAD)
+	{
+		for (unsigned int i = 0; i < cones.size(); i++)
+		{
+			cones[i]->Update();
+		}
+		return;
+	}
+	if (_workers.empty())
+	{
+		int nrOfWorkers = (int)std::thread::hardware_concurrency() - 1;		//The calling thread makes up for the last core
+		if (nrOfWorkers < 1)
+		{
+			nrOfWorkers = 1;
+		}
+		else if (nrOfWorkers > MAX_NR_OF_WORKERS)
+		{
+			nrOfWorkers = MAX_NR_OF_WORKERS;
+		}
+		for (int i = 0; i < nrOfWorkers; i++)
+		{
+			_workers.push_back(std::thread(&VisionBatch::RunWorker, this));
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_cones = &cones;
+		_nextCone = 0;
+		_nrOfBusyWorkers = (int)_workers.size();
+		_nrOfBatches++;
+	}
+	_batchStarted.notify_all();
+	UpdateCones();
+	std::unique_lock<std::mutex> lock(_lock);
+	_batchDone.wait(lock, [this]() { return _nrOfBusyWorkers == 0; });
+	_cones = nullptr;
+}
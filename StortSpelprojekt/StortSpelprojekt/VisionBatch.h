@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "VisionCone.h"
+
+/*
+	Updates many vision cones at once, spread over worker threads.
+	The cones only read the tilemap, so nothing may change it while a batch is running.
+*/
+class VisionBatch
+{
+private:
+	std::vector<std::thread> _workers;				//Started with the first batch big enough to share
+	std::mutex _lock;								//Guards everything below except _nextCone
+	std::condition_variable _batchStarted;
+	std::condition_variable _batchDone;
+	std::vector<VisionCone*>* _cones;				//The batch being run
+	std::atomic<int> _nextCone;						//Index of the next cone for any thread to take
+	unsigned int _nrOfBatches;						//Lets a worker tell a new batch from the one it just finished
+	int _nrOfBusyWorkers;
+	bool _stopping;
+
+	void RunWorker();
+	void UpdateCones();
+
+	VisionBatch(const VisionBatch&) = delete;
+	VisionBatch& operator=(const VisionBatch&) = delete;
+public:
+	static const int MAX_NR_OF_WORKERS = 4;
+	static const int MIN_NR_OF_CONES_PER_THREAD = 4;	//Smaller batches aren't worth waking the workers for
+
+	VisionBatch();
+	~VisionBatch();
+
+	void Update(std::vector<VisionCone*>& cones);		//Returns when every cone is up to date
+};
@@ -23,7 +23,7 @@ void VisionCone::ScanOctant(int depth, int octant, double &startSlope, double en
 		startCornerVec = AI::Vec2D(-1, 1);//Is multiplied with 0.5
 
 		y = unitPosY + depth;
-		if (y < 0)
+		if (y >= _tileMap->GetHeight())
 		{
 			return;
 		}
@@ -211,31 +211,197 @@ int VisionCone::GetVisDistance(int x1, int y1, int x2, int y2)
 	return (x1 - x2) * (x1 - x2) + ((y1 - y2) * (y1 - y2));
 }
 
+/*
+Throws away the cones that may see differently since the tilemap last changed. Walls are only looked for
+within the radius, plus one tile for the neighbour checks, so other changes leave the cones alone.
+If the tilemap no longer remembers all its changes, everything has to go.
+*/
+void VisionCone::ClearOutdatedCache()
+{
+	if (_cacheVersion == _tileMap->GetVersion())
+	{
+		return;
+	}
+	std::vector<Tilemap::TileChange> changes;
+	if (!_tileMap->GetChanges(_cacheVersion, changes))
+	{
+		for (int i = 0; i < CONE_CACHE_SIZE; i++)
+		{
+			_cachedCones[i]._isUsed = false;
+		}
+	}
+	for (unsigned int i = 0; i < changes.size(); i++)
+	{
+		if (changes[i]._oldType == System::WALL || changes[i]._newType == System::WALL)
+		{
+			for (int j = 0; j < CONE_CACHE_SIZE; j++)
+			{
+				CachedCone& cone = _cachedCones[j];
+				if (abs(cone._pos._x - changes[i]._pos._x) <= _radius + 1 && abs(cone._pos._y - changes[i]._pos._y) <= _radius + 1)
+				{
+					cone._isUsed = false;
+				}
+			}
+		}
+	}
+	_cacheVersion = _tileMap->GetVersion();
+}
+
+bool VisionCone::FindCachedTiles(AI::Vec2D pos, AI::Vec2D dir)
+{
+	ClearOutdatedCache();
+	for (int i = 0; i < CONE_CACHE_SIZE; i++)
+	{
+		CachedCone& cached = _cachedCones[i];
+		if (cached._isUsed && cached._pos == pos && cached._dir == dir)
+		{
+			cached._lastUse = ++_cacheClock;
+			_nrOfVisibleTiles = cached._nrOfTiles;
+			for (int j = 0; j < _nrOfVisibleTiles; j++)
+			{
+				_visibleTiles[j] = AI::Vec2D(pos._x + cached._offsets[2 * j], pos._y + cached._offsets[2 * j + 1]);
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+Stores the cone in an unused entry, or else in the one that has gone the longest without being found
+*/
+void VisionCone::CacheVisibleTiles(AI::Vec2D pos, AI::Vec2D dir)
+{
+	CachedCone* replaced = &_cachedCones[0];
+	for (int i = 0; i < CONE_CACHE_SIZE && replaced->_isUsed; i++)
+	{
+		if (!_cachedCones[i]._isUsed || _cachedCones[i]._lastUse < replaced->_lastUse)
+		{
+			replaced = &_cachedCones[i];
+		}
+	}
+	CachedCone& entry = *replaced;
+	entry._isUsed = true;
+	entry._pos = pos;
+	entry._dir = dir;
+	entry._lastUse = ++_cacheClock;
+	entry._nrOfTiles = _nrOfVisibleTiles;
+	for (int i = 0; i < _nrOfVisibleTiles; i++)
+	{
+		entry._offsets[2 * i] = (__int8)(_visibleTiles[i]._x - pos._x);
+		entry._offsets[2 * i + 1] = (__int8)(_visibleTiles[i]._y - pos._y);
+	}
+}
+
+void VisionCone::BuildRowMasks()
+{
+	for (int i = 0; i < 2 * _radius + 1; i++)
+	{
+		_rowMasks[i] = 0;
+	}
+	for (int i = 0; i < _nrOfVisibleTiles; i++)
+	{
+		_rowMasks[_visibleTiles[i]._y - _pos._y + _radius] |= 1U << (_visibleTiles[i]._x - _pos._x + _radius);
+	}
+}
+
 VisionCone::VisionCone()
 {
 	_radius = 0;
 	_tileMap = nullptr;
 	_visibleTiles = nullptr;
 	_nrOfVisibleTiles = 0;
+	_rowMasks = nullptr;
+	_isOutdated = false;
+	for (int i = 0; i < CONE_CACHE_SIZE; i++)
+	{
+		_cachedCones[i]._isUsed = false;
+		_cachedCones[i]._offsets = nullptr;
+	}
+	_cacheClock = 0;
+	_cacheVersion = 0;
+	_nrOfCacheHits = 0;
+	_nrOfCacheMisses = 0;
 }
 
+/*
+The radius comes from the blueprints, so it is clamped rather than trusted. The row masks, the cached offsets and
+VisibilityGrid::AddCone all depend on it being at most MAX_RADIUS.
+Every cache entry gets room for as many offsets as there can be visible tiles up front, so a cache miss never allocates
+*/
 VisionCone::VisionCone(int radius, const Tilemap* tileMap)
 {
-	_radius = radius;
+	_radius = radius < 0 ? 0 : (radius > MAX_RADIUS ? MAX_RADIUS : radius);
 	_tileMap = tileMap;
-	_visibleTiles = new AI::Vec2D[radius * (radius + 1)];
+	_visibleTiles = (AI::Vec2D*)ObjectPool::AllocateShared(sizeof(AI::Vec2D) * _radius * (_radius + 1));
 	_nrOfVisibleTiles = 0;
+	_rowMasks = (unsigned int*)ObjectPool::AllocateShared(sizeof(unsigned int) * (2 * _radius + 1));
+	for (int i = 0; i < 2 * _radius + 1; i++)
+	{
+		_rowMasks[i] = 0;
+	}
+	_isOutdated = false;
+	for (int i = 0; i < CONE_CACHE_SIZE; i++)
+	{
+		_cachedCones[i]._isUsed = false;
+		_cachedCones[i]._lastUse = 0;
+		_cachedCones[i]._nrOfTiles = 0;
+		_cachedCones[i]._offsets = (__int8*)ObjectPool::AllocateShared(2 * _radius * (_radius + 1));
+	}
+	_cacheClock = 0;
+	_cacheVersion = tileMap->GetVersion();
+	_nrOfCacheHits = 0;
+	_nrOfCacheMisses = 0;
 }
 
 VisionCone::~VisionCone()
 {
-	delete[] _visibleTiles;
-	_visibleTiles = nullptr;
+	if (_visibleTiles != nullptr)
+	{
+		ObjectPool::FreeShared(_visibleTiles, sizeof(AI::Vec2D) * _radius * (_radius + 1));
+		_visibleTiles = nullptr;
+	}
+	if (_rowMasks != nullptr)
+	{
+		ObjectPool::FreeShared(_rowMasks, sizeof(unsigned int) * (2 * _radius + 1));
+		_rowMasks = nullptr;
+	}
+	for (int i = 0; i < CONE_CACHE_SIZE; i++)
+	{
+		if (_cachedCones[i]._offsets != nullptr)
+		{
+			ObjectPool::FreeShared(_cachedCones[i]._offsets, 2 * _radius * (_radius + 1));
+			_cachedCones[i]._offsets = nullptr;
+		}
+	}
 	_nrOfVisibleTiles = 0;
 }
 
+void* VisionCone::operator new(size_t i)
+{
+	return ObjectPool::AllocateShared(i);
+}
+
+void VisionCone::operator delete(void* p, size_t i)
+{
+	ObjectPool::FreeShared(p, i);
+}
+
+/*
+Units walking back and forth and cameras turning between the same directions keep looking from the same tiles,
+so the cone is only scanned if it isn't cached
+*/
 void VisionCone::FindVisibleTiles(AI::Vec2D pos, AI::Vec2D dir)
 {
+	_isOutdated = false;
+	_pos = pos;
+	if (FindCachedTiles(pos, dir))
+	{
+		_nrOfCacheHits++;
+		BuildRowMasks();
+		return;
+	}
+	_nrOfCacheMisses++;
 	double startSlope = 1.0;
 	_visibleTiles[0] = AI::Vec2D(pos._x, pos._y);
 	_nrOfVisibleTiles = 1;
@@ -254,6 +420,28 @@ void VisionCone::FindVisibleTiles(AI::Vec2D pos, AI::Vec2D dir)
 	octant = octant % 8 + 1;
 	startSlope = 1.0;
 	ScanOctant(1, octant, startSlope, 0.0, pos, dir);
+	CacheVisibleTiles(pos, dir);
+	BuildRowMasks();
+}
+
+void VisionCone::RequestUpdate(AI::Vec2D pos, AI::Vec2D dir)
+{
+	_requestedPos = pos;
+	_requestedDir = dir;
+	_isOutdated = true;
+}
+
+void VisionCone::Update()
+{
+	if (_isOutdated)
+	{
+		FindVisibleTiles(_requestedPos, _requestedDir);
+	}
+}
+
+bool VisionCone::IsOutdated() const
+{
+	return _isOutdated;
 }
 
 AI::Vec2D * VisionCone::GetVisibleTiles() const
@@ -271,6 +459,31 @@ int VisionCone::GetNrOfVisibleTiles() const
 	return _nrOfVisibleTiles;
 }
 
+AI::Vec2D VisionCone::GetPosition() const
+{
+	return _pos;
+}
+
+int VisionCone::GetRadius() const
+{
+	return _radius;
+}
+
+unsigned int VisionCone::GetRowMask(int row) const
+{
+	return _rowMasks[row];
+}
+
+int VisionCone::GetNrOfCacheHits() const
+{
+	return _nrOfCacheHits;
+}
+
+int VisionCone::GetNrOfCacheMisses() const
+{
+	return _nrOfCacheMisses;
+}
+
 void VisionCone::ColorVisibleTiles(const DirectX::XMFLOAT3& color)
 {
 	//for (int i = 0; i < _nrOfVisibleTiles; i++)
@@ -1,27 +1,74 @@
 #pragma once
 #include "Tilemap.h"
 #include "AIUtil.h"
+#include "ObjectPool.h"
 
 class VisionCone
 {
+public:
+	static const int CONE_CACHE_SIZE = 32;
+	static const int MAX_RADIUS = 15;				//Larger radii are clamped, a row mask has to fit in 32 bits and an offset in an __int8
+
 private:
 	const Tilemap* _tileMap;
 	int _radius;
 	AI::Vec2D* _visibleTiles;
 	int _nrOfVisibleTiles;
+	AI::Vec2D _pos;									//Where the visible tiles were found from
+	unsigned int* _rowMasks;						//Visible tiles of each row from _pos._y - _radius, bit i meaning x = _pos._x - _radius + i
+	AI::Vec2D _requestedPos;						//Where the cone is looked for from at the next Update
+	AI::Vec2D _requestedDir;
+	bool _isOutdated;								//An update has been requested but not yet done
+
+	/*
+		Cones found earlier. Only walls block the view, so a cone stays valid until a wall near it changes
+	*/
+	struct CachedCone
+	{
+		bool _isUsed;
+		AI::Vec2D _pos;
+		AI::Vec2D _dir;
+		unsigned int _lastUse;					//_cacheClock when the cone was last stored or found
+		int _nrOfTiles;
+		__int8* _offsets;						//x and y of every visible tile relative to _pos, in the order they were found
+	};
+	CachedCone _cachedCones[CONE_CACHE_SIZE];	//The least recently used is replaced when all are used
+	unsigned int _cacheClock;
+	unsigned int _cacheVersion;					//Tilemap version the cache is up to date with
+	int _nrOfCacheHits;
+	int _nrOfCacheMisses;
 
 	void ScanOctant(int depth, int octant, double &startSlope, double endSlope, AI::Vec2D pos, AI::Vec2D dir);
 	double GetSlope(double x1, double y1, double x2, double y2, bool invert);
 	int GetVisDistance(int x1, int y1, int x2, int y2);
+	void ClearOutdatedCache();
+	bool FindCachedTiles(AI::Vec2D pos, AI::Vec2D dir);
+	void CacheVisibleTiles(AI::Vec2D pos, AI::Vec2D dir);
+	void BuildRowMasks();
+
+	VisionCone(const VisionCone&) = delete;
+	VisionCone& operator=(const VisionCone&) = delete;
 public:
 	VisionCone();
 	VisionCone(int radius, const Tilemap* tileMap);
 	~VisionCone();
+
+	//The cones, their tile arrays and their cached offsets are taken from the shared object pools, since they come and go with the units
+	void* operator new(size_t i);
+	void operator delete(void* p, size_t i);
 	void FindVisibleTiles(AI::Vec2D pos, AI::Vec2D dir);
+	void RequestUpdate(AI::Vec2D pos, AI::Vec2D dir);	//Defers FindVisibleTiles to the next Update, so that cones can be found in batches
+	void Update();										//Does the requested update, if any
+	bool IsOutdated()const;
 
 	AI::Vec2D* GetVisibleTiles()const;
 	AI::Vec2D GetVisibleTile(int index)const;
 	int GetNrOfVisibleTiles()const;
+	AI::Vec2D GetPosition()const;
+	int GetRadius()const;
+	unsigned int GetRowMask(int row)const;				//Row 0 to 2 * radius, see _rowMasks
+	int GetNrOfCacheHits()const;
+	int GetNrOfCacheMisses()const;
 
 	void ColorVisibleTiles(const DirectX::XMFLOAT3& color);
 };
\ No newline at end of file
@@ -2,7 +2,7 @@
 #define CAMERA_H
 #include <DirectXMath.h>
 
-#include "Settings/settings.h"
+#include "Settings/Settings.h"
 
 
 #define CAMERA_EXPORT __declspec(dllexport)
@@ -83,6 +83,7 @@ namespace System
 	}
 	/*
 		Timer that countdowns 1 each time it's called
+		Game objects call it once per tick, with times converted to ticks by GameObject::FramesToTicks
 		When below stopTime it will reset to startTime
 		When above stopTime it will count down
 		When equal to stopTime it will return true and then tick down to indicate it's finished
@@ -1,4 +1,4 @@
-#include "settings.h"
+#include "Settings.h"
 namespace System
 {
 	Settings::Settings()
@@ -16,6 +16,8 @@ namespace System
 		_antialiasing = true;
 		_volume = 100;
 		_brightness = 5;
+		_ticksPerSecond = 60;
+		_maxTicksPerFrame = 5;
 	}
 
 	Settings::~Settings()
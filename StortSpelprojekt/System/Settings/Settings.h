@@ -27,6 +27,8 @@ namespace System
 		bool _showMouseCursor;
 		bool _antialiasing;
 		int _brightness;
+		unsigned int _ticksPerSecond;		//Rate of the game logic, independent of the frame rate
+		unsigned int _maxTicksPerFrame;		//Ticks to catch up on before the game is allowed to slow down
 	public:
 		Settings();
 		~Settings();
@@ -47,7 +49,9 @@ namespace System
 				CEREAL_NVP(_fov),
 				CEREAL_NVP(_antialiasing),
 				CEREAL_NVP(_volume),
-				CEREAL_NVP(_brightness)
+				CEREAL_NVP(_brightness),
+				CEREAL_NVP(_ticksPerSecond),
+				CEREAL_NVP(_maxTicksPerFrame)
 				);
 		}
 	};
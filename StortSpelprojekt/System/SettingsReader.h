@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Settings/settings.h"
+#include "Settings/Settings.h"
 #include "Settings/Profile.h"
 #include "CommonUtils.h"
 
@@ -29,14 +29,22 @@ namespace System
 		Profile* GetProfile();
 		void ApplyProfileSettings();
 
+		/*
+		Fields are read in order, so a file saved before a field was added still loads everything it has and the
+		rest keeps the default from the constructor. Cereal throws when it misses a field, which is caught here
+		*/
 		template<typename Archive>
 		void LoadXML(const std::string& filename, Archive& a)
 		{
 			std::ifstream is(filename);
 			if (is.is_open())
 			{
-				cereal::XMLInputArchive inArchive(is);
-				inArchive(a);
+				try
+				{
+					cereal::XMLInputArchive inArchive(is);
+					inArchive(a);
+				}
+				catch (const cereal::Exception&) {}
 			}
 		}
 
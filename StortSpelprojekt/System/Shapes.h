@@ -5,6 +5,11 @@
 #include "VectorMath.h"
 #include <vector>
 
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#include <xmmintrin.h>
+#define SHAPES_USE_SSE
+#endif
+
 
 struct Ray
 {
@@ -159,7 +164,7 @@ static Vec3 FindClosestPointOnVector(Vec3 &point, Ray &vector)
 
 
 //Separating Axis Theorem check for vectors
-static bool SATVectorCheck(Vec2 &axis, std::vector<Vec2> *firstObjectCorners, std::vector<Vec2> *secondObjectCorners)
+static bool SATVectorCheck(Vec2 axis, std::vector<Vec2> *firstObjectCorners, std::vector<Vec2> *secondObjectCorners)
 {
 	bool collision = false;
 	float firstMinPoint = axis.Dot(firstObjectCorners->at(0));
@@ -210,7 +215,7 @@ static bool SATVectorCheck(Vec2 &axis, std::vector<Vec2> *firstObjectCorners, st
 	return collision;
 }
 
-static bool SATVectorCheck(Vec3 &axis, std::vector<Vec3> *firstObjectCorners, std::vector<Vec3> *secondObjectCorners)
+static bool SATVectorCheck(Vec3 axis, std::vector<Vec3> *firstObjectCorners, std::vector<Vec3> *secondObjectCorners)
 {
 	bool collision = false;
 	float firstMinPoint = axis.Dot(firstObjectCorners->at(0));
@@ -328,7 +333,7 @@ static std::vector<Vec3>* FindBoxCorners(Box &box)
 
 
 
-static const bool Collision(Vec2 &point, Square &square)
+static const bool Collision(Vec2 point, Square &square)
 {
 	return (point._x < square._maxPos._x &&
 		point._x > square._minPos._x &&
@@ -336,7 +341,7 @@ static const bool Collision(Vec2 &point, Square &square)
 		point._y > square._minPos._y);
 }
 
-static const bool Collision(Vec2 &point, Triangle &triangle)
+static const bool Collision(Vec2 point, Triangle &triangle)
 {
 	Vec2 p0 = Vec2(triangle._pos1._x, triangle._pos1._z);
 	Vec2 p1 = Vec2(triangle._pos2._x, triangle._pos2._z);
@@ -350,7 +355,7 @@ static const bool Collision(Vec2 &point, Triangle &triangle)
 	return s > 0 && t > 0 && 1 - s - t > 0;
 }
 
-static const bool Collision(Vec2 &point, Circle &circle)
+static const bool Collision(Vec2 point, Circle &circle)
 {
 	return (point - circle._position).Length() < circle._radius;
 }
@@ -574,6 +579,110 @@ static const bool Collision(std::vector<Vec2>* polygon1, std::vector<Vec2>* poly
 	return collision;
 }
 
+//Number of polygon edges tested together by the batch collision below, bigger polygons are tested in several rounds
+static const unsigned int MAX_NR_OF_BATCH_AXES = 16;
+
+/*
+Tests one convex polygon against nrOfSquares axis aligned squares, given as one array per bound.
+collisions[i] is set to whether square i touches the polygon. Four squares are tested at a time with SSE where available.
+Unlike the corner list functions above, every edge of the polygon is tested, including the one from the last corner to the first,
+and squares that only touch the polygon count as colliding. Squares with the same min and max can be used for points.
+*/
+static void Collision(std::vector<Vec2>* polygon, const float* minX, const float* minY, const float* maxX, const float* maxY, unsigned int nrOfSquares, bool* collisions)
+{
+	unsigned int size = polygon->size();
+	for (unsigned int i = 0; i < nrOfSquares; i++)
+	{
+		collisions[i] = size > 0;
+	}
+	if (size == 0)
+	{
+		return;
+	}
+
+	//The x and y axes of the squares
+	float polygonMinX = polygon->at(0)._x, polygonMaxX = polygonMinX;
+	float polygonMinY = polygon->at(0)._y, polygonMaxY = polygonMinY;
+	for (unsigned int i = 1; i < size; i++)
+	{
+		polygonMinX = polygon->at(i)._x < polygonMinX ? polygon->at(i)._x : polygonMinX;
+		polygonMaxX = polygon->at(i)._x > polygonMaxX ? polygon->at(i)._x : polygonMaxX;
+		polygonMinY = polygon->at(i)._y < polygonMinY ? polygon->at(i)._y : polygonMinY;
+		polygonMaxY = polygon->at(i)._y > polygonMaxY ? polygon->at(i)._y : polygonMaxY;
+	}
+
+	for (unsigned int firstEdge = 0; firstEdge < size; firstEdge += MAX_NR_OF_BATCH_AXES)
+	{
+		//Project the polygon on the normal of each edge. A square is projected by picking the corner furthest
+		//along or against the normal, which only depends on the signs of the normal
+		Vec2 axes[MAX_NR_OF_BATCH_AXES];
+		float axisMin[MAX_NR_OF_BATCH_AXES];
+		float axisMax[MAX_NR_OF_BATCH_AXES];
+		unsigned int nrOfAxes = 0;
+		for (unsigned int i = firstEdge; i < size && nrOfAxes < MAX_NR_OF_BATCH_AXES; i++)
+		{
+			Vec2 edge = polygon->at((i + 1) % size) - polygon->at(i);
+			Vec2 axis = Vec2(-edge._y, edge._x);
+			axisMin[nrOfAxes] = axis._x * polygon->at(0)._x + axis._y * polygon->at(0)._y;
+			axisMax[nrOfAxes] = axisMin[nrOfAxes];
+			for (unsigned int j = 1; j < size; j++)
+			{
+				float point = axis._x * polygon->at(j)._x + axis._y * polygon->at(j)._y;
+				axisMin[nrOfAxes] = point < axisMin[nrOfAxes] ? point : axisMin[nrOfAxes];
+				axisMax[nrOfAxes] = point > axisMax[nrOfAxes] ? point : axisMax[nrOfAxes];
+			}
+			axes[nrOfAxes++] = axis;
+		}
+
+		unsigned int i = 0;
+#ifdef SHAPES_USE_SSE
+		for (; i + 4 <= nrOfSquares; i += 4)
+		{
+			__m128 squareMinX = _mm_loadu_ps(minX + i);
+			__m128 squareMinY = _mm_loadu_ps(minY + i);
+			__m128 squareMaxX = _mm_loadu_ps(maxX + i);
+			__m128 squareMaxY = _mm_loadu_ps(maxY + i);
+
+			__m128 overlap = _mm_and_ps(
+				_mm_and_ps(_mm_cmple_ps(squareMinX, _mm_set1_ps(polygonMaxX)), _mm_cmpge_ps(squareMaxX, _mm_set1_ps(polygonMinX))),
+				_mm_and_ps(_mm_cmple_ps(squareMinY, _mm_set1_ps(polygonMaxY)), _mm_cmpge_ps(squareMaxY, _mm_set1_ps(polygonMinY))));
+
+			for (unsigned int j = 0; j < nrOfAxes; j++)
+			{
+				__m128 axisX = _mm_set1_ps(axes[j]._x);
+				__m128 axisY = _mm_set1_ps(axes[j]._y);
+				__m128 lowest = _mm_add_ps(
+					_mm_mul_ps(axes[j]._x >= 0.0f ? squareMinX : squareMaxX, axisX),
+					_mm_mul_ps(axes[j]._y >= 0.0f ? squareMinY : squareMaxY, axisY));
+				__m128 highest = _mm_add_ps(
+					_mm_mul_ps(axes[j]._x >= 0.0f ? squareMaxX : squareMinX, axisX),
+					_mm_mul_ps(axes[j]._y >= 0.0f ? squareMaxY : squareMinY, axisY));
+				overlap = _mm_and_ps(overlap, _mm_and_ps(
+					_mm_cmple_ps(lowest, _mm_set1_ps(axisMax[j])),
+					_mm_cmpge_ps(highest, _mm_set1_ps(axisMin[j]))));
+			}
+
+			int mask = _mm_movemask_ps(overlap);
+			for (int j = 0; j < 4; j++)
+			{
+				collisions[i + j] = collisions[i + j] && (mask & (1 << j)) != 0;
+			}
+		}
+#endif
+		for (; i < nrOfSquares; i++)
+		{
+			bool overlap = minX[i] <= polygonMaxX && maxX[i] >= polygonMinX && minY[i] <= polygonMaxY && maxY[i] >= polygonMinY;
+			for (unsigned int j = 0; j < nrOfAxes && overlap; j++)
+			{
+				float lowest = (axes[j]._x >= 0.0f ? minX[i] : maxX[i]) * axes[j]._x + (axes[j]._y >= 0.0f ? minY[i] : maxY[i]) * axes[j]._y;
+				float highest = (axes[j]._x >= 0.0f ? maxX[i] : minX[i]) * axes[j]._x + (axes[j]._y >= 0.0f ? maxY[i] : minY[i]) * axes[j]._y;
+				overlap = lowest <= axisMax[j] && highest >= axisMin[j];
+			}
+			collisions[i] = collisions[i] && overlap;
+		}
+	}
+}
+
 
 static const bool Collision(Vec3 &point, Square &square)
 {
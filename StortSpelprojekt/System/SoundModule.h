@@ -2,14 +2,14 @@
 #define SYSTEM_EXPORT __declspec(dllexport)
 
 
-#include "yse\yse.hpp"
+#include "yse/yse.hpp"
 #include <map>
 #include <string>
 #include <vector>
 #include <mmdeviceapi.h>
 #include <DirectXMath.h>
 
-#include "Settings\Settings.h"
+#include "Settings/Settings.h"
 
 #pragma comment(lib, "libyse32.lib")
 
@@ -0,0 +1,132 @@
+#include "InstanceBatcher.h"
+#include "Test.h"
+
+/*
+Adds instances of a few render objects in mixed order and checks that Build groups them into one batch per
+render object, ordered like the sort in Build, with the instances of every batch kept in the order they were added.
+The instance of add number i is translated to (i, 0, 0) and has the color offset (i, 0, 0), so it can be told
+apart from the others after the grouping.
+*/
+
+static const unsigned int NR_OF_RENDER_OBJECTS = 3;
+static const unsigned int MAX_NR_OF_INSTANCES = 600;
+
+static DirectX::XMMATRIX worlds[MAX_NR_OF_INSTANCES];
+
+static float GetAddNumber(const InstanceData& instance)
+{
+	DirectX::XMFLOAT4X4 world;
+	DirectX::XMStoreFloat4x4(&world, instance._world);
+	return world._41;
+}
+
+static void AddInstances(InstanceBatcher& batcher, RenderObject* renderObjects, const unsigned int* order, unsigned int nrOfInstances)
+{
+	for (unsigned int i = 0; i < nrOfInstances; i++)
+	{
+		worlds[i] = DirectX::XMMatrixTranslation((float)i, 0.0f, 0.0f);
+		batcher.Add(&renderObjects[order[i]], &worlds[i], DirectX::XMFLOAT3((float)i, 0.0f, 0.0f));
+	}
+}
+
+/*
+Checks the batches against the order the instances were added in
+*/
+static void CheckBatches(const InstanceBatcher& batcher, RenderObject* renderObjects, const unsigned int* order, unsigned int nrOfInstances)
+{
+	const std::vector<InstanceBatcher::Batch>& batches = batcher.GetBatches();
+	const InstanceData* instances = batcher.GetInstances();
+	CHECK(batcher.GetNrOfInstances() == nrOfInstances);
+	CHECK(((size_t)instances & 15) == 0);
+
+	unsigned int nrOfUsedRenderObjects = 0;
+	for (unsigned int i = 0; i < NR_OF_RENDER_OBJECTS; i++)
+	{
+		for (unsigned int j = 0; j < nrOfInstances; j++)
+		{
+			if (order[j] == i)
+			{
+				nrOfUsedRenderObjects++;
+				break;
+			}
+		}
+	}
+	CHECK(batches.size() == nrOfUsedRenderObjects);
+
+	unsigned int nextInstance = 0;
+	for (unsigned int i = 0; i < batches.size(); i++)
+	{
+		//The batches cover the instances without gaps, in the order of their render objects
+		CHECK(batches[i]._firstInstance == nextInstance);
+		CHECK(batches[i]._nrOfInstances > 0);
+		CHECK(i == 0 || batches[i - 1]._renderObject < batches[i]._renderObject);
+		nextInstance += batches[i]._nrOfInstances;
+
+		unsigned int renderObjectIndex = batches[i]._renderObject - renderObjects;
+		unsigned int instance = batches[i]._firstInstance;
+		for (unsigned int j = 0; j < nrOfInstances; j++)
+		{
+			if (order[j] != renderObjectIndex)
+			{
+				continue;
+			}
+			if (instance >= batches[i]._firstInstance + batches[i]._nrOfInstances)
+			{
+				CHECK(!"more instances of the render object than in its batch");
+				break;
+			}
+			CHECK(GetAddNumber(instances[instance]) == (float)j);
+			CHECK(instances[instance]._colorOffset.x == (float)j);
+			CHECK(instances[instance]._colorOffset.w == 0.0f);
+			instance++;
+		}
+		CHECK(instance == batches[i]._firstInstance + batches[i]._nrOfInstances);
+	}
+	CHECK(nextInstance == nrOfInstances);
+}
+
+static void TestMixedOrder(RenderObject* renderObjects)
+{
+	static const unsigned int ORDER[] = { 2, 0, 1, 0, 2, 2, 1, 0 };
+	static const unsigned int NR_OF_INSTANCES = sizeof(ORDER) / sizeof(ORDER[0]);
+
+	InstanceBatcher batcher;
+	AddInstances(batcher, renderObjects, ORDER, NR_OF_INSTANCES);
+	batcher.Build();
+	CheckBatches(batcher, renderObjects, ORDER, NR_OF_INSTANCES);
+}
+
+/*
+One render object left out, and more instances than the first allocation has room for after a Clear
+*/
+static void TestClearAndGrow(RenderObject* renderObjects)
+{
+	static const unsigned int SMALL_ORDER[] = { 1, 1, 0 };
+	static unsigned int largeOrder[MAX_NR_OF_INSTANCES];
+	for (unsigned int i = 0; i < MAX_NR_OF_INSTANCES; i++)
+	{
+		largeOrder[i] = (i * 7) % NR_OF_RENDER_OBJECTS;
+	}
+
+	InstanceBatcher batcher;
+	AddInstances(batcher, renderObjects, SMALL_ORDER, 3);
+	batcher.Build();
+	CheckBatches(batcher, renderObjects, SMALL_ORDER, 3);
+
+	batcher.Clear();
+	CHECK(batcher.GetNrOfInstances() == 0);
+	CHECK(batcher.GetBatches().empty());
+
+	AddInstances(batcher, renderObjects, largeOrder, MAX_NR_OF_INSTANCES);
+	batcher.Build();
+	CheckBatches(batcher, renderObjects, largeOrder, MAX_NR_OF_INSTANCES);
+}
+
+int main()
+{
+	RenderObject renderObjects[NR_OF_RENDER_OBJECTS];
+	TestMixedOrder(renderObjects);
+	TestClearAndGrow(renderObjects);
+	printf("InstanceBatcherTest: %d failed checks\n", nrOfFailedChecks);
+	return nrOfFailedChecks;
+}
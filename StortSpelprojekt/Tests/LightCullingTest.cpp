@@ -0,0 +1,114 @@
+#include "LightCulling.h"
+#include "Test.h"
+
+using namespace DirectX;
+
+/*
+Projects the frusta of cameras with known view and projection matrices onto the ground with
+LightCulling::TransformFrustum. The part of every frustum between the ground and MAX_OBJECT_HEIGHT, 3, is
+worked out by hand below, and the rectangle is its bounding box grown by FRUSTUM_MARGIN, 1.
+*/
+
+static const float TOLERANCE = 0.001f;
+
+static XMMATRIX ViewProjection(XMFLOAT3 eye, XMFLOAT3 focus, XMFLOAT3 up, const XMMATRIX& projection)
+{
+	XMMATRIX view = XMMatrixLookAtLH(XMLoadFloat3(&eye), XMLoadFloat3(&focus), XMLoadFloat3(&up));
+	return XMMatrixMultiply(view, projection);
+}
+
+static bool IsNear(Vec2 point, float x, float z)
+{
+	return std::abs(point._x - x) < TOLERANCE && std::abs(point._y - z) < TOLERANCE;
+}
+
+static void CheckRectangle(const XMMATRIX& viewProjection, float minX, float minZ, float maxX, float maxZ)
+{
+	std::vector<Vec2> rectangle;
+	CHECK(LightCulling::TransformFrustum(viewProjection, &rectangle));
+	CHECK(rectangle.size() == 4);
+	if (rectangle.size() == 4)
+	{
+		CHECK(IsNear(rectangle[0], minX, minZ));
+		CHECK(IsNear(rectangle[1], maxX, minZ));
+		CHECK(IsNear(rectangle[2], maxX, maxZ));
+		CHECK(IsNear(rectangle[3], minX, maxZ));
+	}
+}
+
+static void CheckNothingVisible(const XMMATRIX& viewProjection)
+{
+	//Filled first to check that the old content is cleared
+	std::vector<Vec2> rectangle(4, Vec2(1.0f, 1.0f));
+	CHECK(!LightCulling::TransformFrustum(viewProjection, &rectangle));
+	CHECK(rectangle.empty());
+}
+
+/*
+Straight down from 20 above (10, 5) with an 8 by 6 view, so the frustum is the box x 6 to 14 and z 2 to 8
+*/
+static void TestOrthographicDown()
+{
+	XMMATRIX projection = XMMatrixOrthographicLH(8.0f, 6.0f, 1.0f, 100.0f);
+	CheckRectangle(ViewProjection(XMFLOAT3(10, 20, 5), XMFLOAT3(10, 0, 5), XMFLOAT3(0, 0, 1), projection), 5.0f, 1.0f, 15.0f, 9.0f);
+}
+
+/*
+Straight down from 10 above the origin with a 90 degree field of view. The frustum is 20 wide at the ground and
+14 wide at the top of the objects, so the ground is the widest part
+*/
+static void TestPerspectiveDown()
+{
+	XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 1.0f, 100.0f);
+	CheckRectangle(ViewProjection(XMFLOAT3(0, 10, 0), XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 1), projection), -11.0f, -11.0f, 11.0f, 11.0f);
+}
+
+/*
+As above, but the far plane at 8 ends the frustum 2 above the ground, where it is 16 wide
+*/
+static void TestPerspectiveClippedByFarPlane()
+{
+	XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 1.0f, 8.0f);
+	CheckRectangle(ViewProjection(XMFLOAT3(0, 10, 0), XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 1), projection), -9.0f, -9.0f, 9.0f, 9.0f);
+}
+
+/*
+Looking 45 degrees down along z from 10 above the origin with a 90 degree field of view and the far plane at 20,
+so the lower edge of the view is straight down and the upper edge horizontal. The far plane is 40 wide, and the
+farthest it reaches at the top of the objects is z 20 * sqrt(2) - 7, which makes the top the widest part along z
+*/
+static void TestPerspectiveTilted()
+{
+	XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 1.0f, 20.0f);
+	XMMATRIX viewProjection = ViewProjection(XMFLOAT3(0, 10, 0), XMFLOAT3(0, 0, 10), XMFLOAT3(0, 1, 1), projection);
+	CheckRectangle(viewProjection, -21.0f, -1.0f, 21.0f, 20.0f * sqrtf(2.0f) - 6.0f);
+}
+
+/*
+Cameras that see no part of the space between the ground and the top of the objects
+*/
+static void TestNothingVisible()
+{
+	XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 1.0f, 100.0f);
+	//Straight up
+	CheckNothingVisible(ViewProjection(XMFLOAT3(0, 10, 0), XMFLOAT3(0, 20, 0), XMFLOAT3(0, 0, 1), projection));
+
+	//Tilted up so that the lower edge of a 20 degree view is above the horizon
+	XMMATRIX narrowProjection = XMMatrixPerspectiveFovLH(XMConvertToRadians(20.0f), 1.0f, 1.0f, 100.0f);
+	CheckNothingVisible(ViewProjection(XMFLOAT3(0, 10, 0), XMFLOAT3(0, 12, 10), XMFLOAT3(0, 1, 0), narrowProjection));
+
+	//Straight down, but the far plane ends the frustum above the objects
+	XMMATRIX shortProjection = XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 1.0f, 10.0f);
+	CheckNothingVisible(ViewProjection(XMFLOAT3(0, 20, 0), XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 1), shortProjection));
+}
+
+int main()
+{
+	TestOrthographicDown();
+	TestPerspectiveDown();
+	TestPerspectiveClippedByFarPlane();
+	TestPerspectiveTilted();
+	TestNothingVisible();
+	printf("LightCullingTest: %d failed checks\n", nrOfFailedChecks);
+	return nrOfFailedChecks;
+}
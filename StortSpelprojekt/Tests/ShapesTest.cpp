@@ -0,0 +1,239 @@
+#include <random>
+#include <algorithm>
+#include "Shapes.h"
+#include "Test.h"
+
+/*
+Compares the batch Collision of one polygon against many squares with the corner list overloads. Those skip the
+edge from the last corner to the first, so the polygon they get has its first corner repeated at the end to make
+them test every edge, like the batch does.
+
+Random cases that are within rounding of touching can go either way and are not compared. The square counts in
+BATCH_SIZES cover both the SSE path, four squares at a time, and the scalar loop for the rest.
+*/
+
+static const float BORDER = 0.001f;
+static const unsigned int BATCH_SIZES[] = { 1, 2, 3, 4, 5, 7, 8, 9, 13, 16, 31 };
+static const unsigned int NR_OF_ROUNDS = 300;
+
+static std::vector<Vec2> RandomConvexPolygon(std::mt19937& random, unsigned int nrOfCorners)
+{
+	std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+	std::uniform_real_distribution<float> radius(0.5f, 10.0f);
+	std::uniform_real_distribution<float> angle(0.0f, 2.0f * XM_PI);
+
+	//Corners on a circle, sorted by angle, are always convex
+	std::vector<float> angles(nrOfCorners);
+	for (float& a : angles)
+	{
+		a = angle(random);
+	}
+	std::sort(angles.begin(), angles.end());
+
+	Vec2 center(position(random), position(random));
+	float r = radius(random);
+	std::vector<Vec2> polygon;
+	for (float a : angles)
+	{
+		polygon.push_back(Vec2(center._x + r * cosf(a), center._y + r * sinf(a)));
+	}
+	//Both windings are used by the game
+	if (random() % 2 == 0)
+	{
+		std::reverse(polygon.begin(), polygon.end());
+	}
+	return polygon;
+}
+
+//A point in the bounds of the polygon grown by margin, so a fair share of what is placed there hits the polygon
+static Vec2 RandomPointAround(std::mt19937& random, const std::vector<Vec2>& polygon, float margin)
+{
+	Vec2 minPos = polygon[0], maxPos = polygon[0];
+	for (const Vec2& corner : polygon)
+	{
+		minPos = Vec2(std::min(minPos._x, corner._x), std::min(minPos._y, corner._y));
+		maxPos = Vec2(std::max(maxPos._x, corner._x), std::max(maxPos._y, corner._y));
+	}
+	std::uniform_real_distribution<float> x(minPos._x - margin, maxPos._x + margin);
+	std::uniform_real_distribution<float> y(minPos._y - margin, maxPos._y + margin);
+	return Vec2(x(random), y(random));
+}
+
+static Square RandomSquare(std::mt19937& random, const std::vector<Vec2>& polygon)
+{
+	std::uniform_real_distribution<float> size(0.01f, 4.0f);
+	Vec2 minPos = RandomPointAround(random, polygon, 2.0f) - Vec2(2.0f, 2.0f);
+	return Square(minPos, Vec2(minPos._x + size(random), minPos._y + size(random)));
+}
+
+static std::vector<Vec2> Closed(const std::vector<Vec2>& polygon)
+{
+	std::vector<Vec2> closed = polygon;
+	closed.push_back(polygon[0]);
+	return closed;
+}
+
+static bool CornerListCollision(Square square, const std::vector<Vec2>& polygon)
+{
+	std::vector<Vec2> closed = Closed(polygon);
+	return Collision(square, &closed);
+}
+
+static bool CornerListCollision(Vec2 point, const std::vector<Vec2>& polygon)
+{
+	std::vector<Vec2> closed = Closed(polygon);
+	std::vector<Vec2> points(1, point);
+	return Collision(&points, &closed);
+}
+
+static bool IsOnBorder(Square square, const std::vector<Vec2>& polygon)
+{
+	Square grown(Vec2(square._minPos._x - BORDER, square._minPos._y - BORDER), Vec2(square._maxPos._x + BORDER, square._maxPos._y + BORDER));
+	Square shrunk(Vec2(square._minPos._x + BORDER, square._minPos._y + BORDER), Vec2(square._maxPos._x - BORDER, square._maxPos._y - BORDER));
+	return CornerListCollision(grown, polygon) != CornerListCollision(shrunk, polygon);
+}
+
+static bool IsOnBorder(Vec2 point, const std::vector<Vec2>& polygon)
+{
+	for (unsigned int i = 0; i < polygon.size(); i++)
+	{
+		Vec2 start = polygon[i];
+		Vec2 end = polygon[(i + 1) % polygon.size()];
+		Vec2 edge = end - start;
+		Vec2 toPoint = point - start;
+		if (fabsf(edge._x * toPoint._y - edge._y * toPoint._x) < BORDER * edge.Length())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static void BatchCollision(std::vector<Vec2>& polygon, const std::vector<Square>& squares, bool* collisions)
+{
+	std::vector<float> minX, minY, maxX, maxY;
+	for (const Square& square : squares)
+	{
+		minX.push_back(square._minPos._x);
+		minY.push_back(square._minPos._y);
+		maxX.push_back(square._maxPos._x);
+		maxY.push_back(square._maxPos._y);
+	}
+	Collision(&polygon, minX.data(), minY.data(), maxX.data(), maxY.data(), squares.size(), collisions);
+}
+
+static void TestRandomSquares(std::mt19937& random)
+{
+	unsigned int nrOfCompared = 0;
+	unsigned int nrOfColliding = 0;
+	for (unsigned int round = 0; round < NR_OF_ROUNDS; round++)
+	{
+		//Up to 24 corners, more than MAX_NR_OF_BATCH_AXES so some polygons are tested in two rounds of axes
+		std::vector<Vec2> polygon = RandomConvexPolygon(random, 3 + random() % 22);
+		for (unsigned int nrOfSquares : BATCH_SIZES)
+		{
+			std::vector<Square> squares;
+			for (unsigned int i = 0; i < nrOfSquares; i++)
+			{
+				squares.push_back(RandomSquare(random, polygon));
+			}
+
+			bool collisions[32];
+			BatchCollision(polygon, squares, collisions);
+			for (unsigned int i = 0; i < nrOfSquares; i++)
+			{
+				//The same square alone only goes through the scalar loop
+				bool alone;
+				BatchCollision(polygon, std::vector<Square>(1, squares[i]), &alone);
+				CHECK(alone == collisions[i]);
+
+				if (!IsOnBorder(squares[i], polygon))
+				{
+					bool expected = CornerListCollision(squares[i], polygon);
+					CHECK(collisions[i] == expected);
+					nrOfCompared++;
+					nrOfColliding += expected ? 1 : 0;
+				}
+			}
+		}
+	}
+	//Make sure the random cases are not all on one side
+	CHECK(nrOfColliding > nrOfCompared / 20);
+	CHECK(nrOfColliding < nrOfCompared - nrOfCompared / 20);
+}
+
+/*
+Points are squares with the same min and max, as box picking uses them
+*/
+static void TestRandomPoints(std::mt19937& random)
+{
+	unsigned int nrOfCompared = 0;
+	unsigned int nrOfInside = 0;
+	for (unsigned int round = 0; round < NR_OF_ROUNDS; round++)
+	{
+		std::vector<Vec2> polygon = RandomConvexPolygon(random, 3 + random() % 22);
+		for (unsigned int nrOfPoints : BATCH_SIZES)
+		{
+			std::vector<float> x, y;
+			for (unsigned int i = 0; i < nrOfPoints; i++)
+			{
+				Vec2 point = RandomPointAround(random, polygon, 2.0f);
+				x.push_back(point._x);
+				y.push_back(point._y);
+			}
+
+			bool collisions[32];
+			Collision(&polygon, x.data(), y.data(), x.data(), y.data(), nrOfPoints, collisions);
+			for (unsigned int i = 0; i < nrOfPoints; i++)
+			{
+				Vec2 point(x[i], y[i]);
+				if (!IsOnBorder(point, polygon))
+				{
+					bool expected = CornerListCollision(point, polygon);
+					CHECK(collisions[i] == expected);
+					nrOfCompared++;
+					nrOfInside += expected ? 1 : 0;
+				}
+			}
+		}
+	}
+	CHECK(nrOfInside > nrOfCompared / 20);
+	CHECK(nrOfInside < nrOfCompared - nrOfCompared / 20);
+}
+
+static void TestKnownCases()
+{
+	std::vector<Vec2> triangle;
+	triangle.push_back(Vec2(0.0f, 0.0f));
+	triangle.push_back(Vec2(4.0f, 0.0f));
+	triangle.push_back(Vec2(0.0f, 4.0f));
+
+	//Inside, outside beyond the closing edge only, touching a corner, and far away. Five squares so both paths are used
+	float minX[] = { 0.5f, 2.5f, 4.0f, 10.0f, 0.5f };
+	float minY[] = { 0.5f, 2.5f, -1.0f, 10.0f, 0.5f };
+	float maxX[] = { 1.0f, 3.0f, 5.0f, 11.0f, 1.0f };
+	float maxY[] = { 1.0f, 3.0f, 0.0f, 11.0f, 1.0f };
+	bool collisions[5];
+	Collision(&triangle, minX, minY, maxX, maxY, 5, collisions);
+	CHECK(collisions[0]);
+	CHECK(!collisions[1]);
+	CHECK(collisions[2]);
+	CHECK(!collisions[3]);
+	CHECK(collisions[4]);
+
+	//An empty polygon collides with nothing
+	std::vector<Vec2> empty;
+	collisions[0] = true;
+	Collision(&empty, minX, minY, maxX, maxY, 1, collisions);
+	CHECK(!collisions[0]);
+}
+
+int main()
+{
+	std::mt19937 random(20161017);
+	TestKnownCases();
+	TestRandomSquares(random);
+	TestRandomPoints(random);
+	printf("ShapesTest: %d failed checks\n", nrOfFailedChecks);
+	return nrOfFailedChecks;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdio>
+
+/*
+Checks for the tests in this folder. A failed check prints where it failed and is counted, and the test returns the
+number of failed checks from main, so ctest sees anything but 0 as a failure.
+*/
+static int nrOfFailedChecks = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			nrOfFailedChecks++; \
+		} \
+	} while (false)